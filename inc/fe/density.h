@@ -0,0 +1,76 @@
+#ifndef FE_DENSITY_H
+#define FE_DENSITY_H
+
+#include <fe/world.h>
+#include <fe/noise.h>
+#include <fe/geometries/vchunk.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Lattice spacing of `struct Density` unless set otherwise: 5^3 noise
+// samples instead of 16^3 for a 16 voxel chunk.
+#define FE_DENSITY_DEFAULT_STRIDE 4
+
+/**
+ * A terrain density field, 3D noise of world voxel coordinates times
+ * `frequency`, whose voxels at or above `threshold` are solid. The noise
+ * comes from `backend`; animated fields sample 4D noise instead, with
+ * `time` as the fourth coordinate (in noise units, not scaled by 
+ * `frequency`).
+ *
+ * Low frequency fields barely change between neighboring voxels, so the
+ * noise is only evaluated on a lattice of every `stride` voxels and
+ * trilinearly interpolated in between. The lattice is aligned to world
+ * coordinates rather than to chunks, so neighboring chunks interpolate
+ * from the same samples and stay seamless. A stride of 1 samples every
+ * voxel exactly.
+ */
+struct Density {
+    float frequency;
+    float threshold;
+    uint32_t stride;
+
+    enum NoiseBackend backend;
+    bool animated;
+    float time;
+};
+
+/**
+ * Picks the type of the solid voxel at `voxel`, in world voxel
+ * coordinates, whose density is `density`.
+ */
+typedef uint16_t (*DensityMaterialFn)(struct ChunkCoord voxel, float density,
+                                      void* user);
+
+/**
+ * @brief Returns a still Perlin field of `frequency` and `threshold` 
+ * sampled every `FE_DENSITY_DEFAULT_STRIDE` voxels.
+ */
+struct Density Density__create(float frequency, float threshold);
+
+/**
+ * @brief Hashes the parameters of `density` into `seed`, e.g. to tag
+ * chunks saved from it: fields hash alike only if they sample alike.
+ */
+uint32_t Density_hash(const struct Density* density, uint32_t seed);
+
+/**
+ * @brief Samples `density` at the `size` voxels from `origin`, in world
+ * voxel coordinates, into `out`, x first like `noise3_grid()`.
+ */
+void Density_sample(const struct Density* density, struct ChunkCoord origin,
+                    struct Size3D size, float* out);
+
+/**
+ * @brief Sets the voxels of `chunk`, whose first voxel is at `origin` in
+ * world voxel coordinates, that are solid in `density`. Their type is
+ * picked by `material`, or is `CHUNK_VOXEL_SOLID` if it is NULL; other
+ * voxels are left as they are.
+ */
+void Density_fill(const struct Density* density, struct Chunk* chunk,
+                  struct ChunkCoord origin, DensityMaterialFn material,
+                  void* user);
+
+#endif
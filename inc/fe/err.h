@@ -9,5 +9,6 @@
 #define FE_ERR_LOGGER_FAIL 6
 #define FE_ERR_INFALLIBLE 7
 #define FE_ERR_BAD_ALLOC 8
+#define FE_ERR_THREAD_INIT 9
 
 #endif
@@ -0,0 +1,135 @@
+#ifndef VOXEL_SVO_H
+#define VOXEL_SVO_H
+
+#include <fe/geometries/vchunk.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Deepest supported tree, i.e. volumes of up to 2^20 voxels a side.
+#define VOXEL_DAG_MAX_DEPTH 20
+
+/**
+ * References to the children of a `struct VoxelDag` node. A reference with
+ * `VOXEL_DAG_LEAF` set is a subtree entirely of the voxel type in its low
+ * 16 bits; any other is the index of a node in `nodes`.
+ */
+#define VOXEL_DAG_LEAF 0x80000000u
+#define VOXEL_DAG_LEAF_REF(type) (VOXEL_DAG_LEAF | (uint32_t)(type))
+
+/**
+ * Interior node of a `struct VoxelDag`. Child `i` covers the octant whose
+ * x, y and z halves are given by bits 0, 1 and 2 of `i` (set for the upper
+ * half).
+ */
+struct VoxelDagNode {
+    uint32_t children[8];
+};
+
+/**
+ * A sparse voxel octree over a cube of 2^depth voxels a side, with its
+ * identical subtrees shared. Nodes are never modified once created:
+ * edits build the path from the edited subtree up to a new root, reusing
+ * any node that already exists through `lookup` (open addressing over
+ * node index + 1, 0 is empty), so equal subtrees are always the same
+ * node and uniform subtrees collapse into a leaf reference. Nodes left
+ * unreachable by edits stay allocated until `VoxelDag_compact()`.
+ * Voxel types are those of palette chunks, see `CHUNK_VOXEL_AIR`.
+ */
+struct VoxelDag {
+    uint32_t depth;
+    uint32_t root;
+
+    struct VoxelDagNode* nodes;
+    size_t len;
+    size_t cap;
+
+    uint32_t* lookup;
+    size_t lookup_cap;
+};
+
+/**
+ * First non-air voxel along a ray, see `VoxelDag_raycast()`. `face` is the
+ * face of the voxel the ray entered through, or `CHUNK_FACE_COUNT` if the
+ * ray started inside it.
+ */
+struct VoxelDagHit {
+    struct Size3D pos;
+    uint16_t type;
+    float t;
+    enum ChunkFace face;
+};
+
+/**
+ * @brief Creates an all-air DAG of 2^`depth` voxels a side, to be
+ * destroyed with `VoxelDag_destroy()`. `depth` is clamped to
+ * `VOXEL_DAG_MAX_DEPTH`.
+ */
+struct VoxelDag VoxelDag__create(uint32_t depth);
+
+/**
+ * @brief Returns the number of voxels along each side of `dag`.
+ */
+uint32_t VoxelDag_side(const struct VoxelDag* dag);
+
+/**
+ * @brief Returns the type of the voxel at `pos`, air outside of `dag`.
+ */
+uint16_t VoxelDag_get(const struct VoxelDag* dag, struct Size3D pos);
+
+/**
+ * @brief Sets the voxel at `pos` to `type`. Positions outside of `dag`
+ * are ignored.
+ */
+void VoxelDag_set(struct VoxelDag* dag, struct Size3D pos, uint16_t type);
+
+/**
+ * @brief Replaces the voxels of `dag` from `origin` on with those of
+ * `chunk`. Voxels of chunks without a palette become
+ * `CHUNK_VOXEL_SOLID`.
+ * @return false if `chunk` is not a power of two cube, or if it is not
+ * aligned to its size within `dag`.
+ */
+bool VoxelDag_insert_chunk(struct VoxelDag* dag, const struct Chunk* chunk,
+                           struct Size3D origin);
+
+/**
+ * @brief Extracts the `size` voxels of `dag` from `origin` on into a new
+ * linear chunk of `storage`, e.g. to mesh them. Regions the DAG holds as
+ * a single leaf come back as uniform chunks.
+ */
+struct Chunk VoxelDag_to_chunk(const struct VoxelDag* dag, struct Size3D origin,
+                               struct Size3D size, enum ChunkStorage storage);
+
+/**
+ * @brief Finds the first non-air voxel along the ray from `origin`
+ * towards `dir`, at most `max_t` times `dir` away, in voxel units of
+ * `dag`. Uniform subtrees are crossed in a single step.
+ * @return false if the ray hits nothing, leaving `hit` as it was.
+ */
+bool VoxelDag_raycast(const struct VoxelDag* dag, const float origin[3],
+                      const float dir[3], float max_t,
+                      struct VoxelDagHit* hit);
+
+/**
+ * @brief Returns the number of nodes reachable from the root of `dag`.
+ */
+size_t VoxelDag_count_nodes(const struct VoxelDag* dag);
+
+/**
+ * @brief Returns the bytes held by `dag`, including unreachable nodes.
+ */
+size_t VoxelDag_bytes(const struct VoxelDag* dag);
+
+/**
+ * @brief Drops the nodes of `dag` no longer reachable from its root.
+ */
+void VoxelDag_compact(struct VoxelDag* dag);
+
+/**
+ * @brief Frees the nodes of `dag`.
+ */
+void VoxelDag_destroy(struct VoxelDag* dag);
+
+#endif
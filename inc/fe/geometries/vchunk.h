@@ -2,9 +2,14 @@
 #define VOXEL_CHUNK_H 
 
 #include <glad/gl.h>
+#include <fe/jobs.h>
+#include <fe/pool.h>
+
+#include <pthread.h>
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 struct Size3D {
     uint32_t x;
@@ -17,10 +22,109 @@ struct Voxel {
     uint8_t pad:        7;
 } __attribute__((packed));
 
+/**
+ * How a chunk stores its voxels. Bit chunks only store occupancy, as a 
+ * dense bitset of `row_words` 64-bit words per (y, z) row of voxels, bit 
+ * `x % 64` of word `x / 64` being set if the voxel at (x, y, z) is 
+ * enabled. Rows are ordered like voxels, i.e. row `y + z * size.y`.
+ * Palette chunks store a voxel type per voxel, see `struct ChunkPalette`.
+ */
+enum ChunkStorage {
+    CHUNK_STORAGE_VOXELS = 0, // one `struct Voxel` byte per voxel 
+    CHUNK_STORAGE_BITS,       // one occupancy bit per voxel 
+    CHUNK_STORAGE_PALETTE,    // a palette index per voxel 
+};
+
+/**
+ * Voxel types. Air is the only disabled type; chunks without a palette 
+ * report every enabled voxel as `CHUNK_VOXEL_SOLID`.
+ */
+#define CHUNK_VOXEL_AIR     0
+#define CHUNK_VOXEL_SOLID   1
+
+/**
+ * Voxel types of a palette chunk. `types` holds the distinct types seen 
+ * so far (`types[0]` is always air), and `indices` holds one index into 
+ * `types` per voxel, in voxel order, packed `64 / index_bits` to a word.
+ * The index width starts at 1 bit and doubles up to 16 whenever the 
+ * palette outgrows it. `lookup` maps types back to their index + 1 
+ * (open addressing, 0 is empty) so setting a voxel stays O(1).
+ */
+struct ChunkPalette {
+    uint16_t* types;
+    size_t len;
+    size_t cap;
+
+    uint32_t* lookup;
+    size_t lookup_cap;
+
+    uint32_t index_bits;
+    uint64_t* indices;
+};
+
+/**
+ * Order of voxels in the storage of a chunk. Linear storage is 
+ * x + y * size.x + z * size.x * size.y; Morton storage interleaves the 
+ * bits of x, y and z so that neighbors along every axis stay close in 
+ * memory, which suits neighborhood passes like meshing and AO. Morton 
+ * layout is only available to voxel and palette chunks whose size is a 
+ * power of two cube.
+ */
+enum ChunkLayout {
+    CHUNK_LAYOUT_LINEAR = 0,
+    CHUNK_LAYOUT_MORTON,
+};
+
+/**
+ * Run-length encoding of the storage of a compressed chunk, in storage 
+ * order: run `i` covers the voxels before index `ends[i]` not covered by 
+ * earlier runs, which all hold `values[i]`. Values are palette indices in 
+ * palette chunks (whose palette stays as is), 0 or 1 otherwise. Both 
+ * arrays share a single buffer.
+ */
+struct ChunkRuns {
+    uint32_t* ends;
+    uint16_t* values;
+    size_t len;
+};
+
 struct Chunk {
     double scale;
     struct Size3D size;
-    struct Voxel* voxels;
+    struct Voxel* voxels; // CHUNK_STORAGE_VOXELS only 
+
+    enum ChunkStorage storage;
+    enum ChunkLayout layout;
+    uint8_t size_log2;    // see `CHUNK_FIXED_SIZES`, 0 for other sizes 
+
+    // Uniform chunks are entirely `uniform_type` and hold no storage until
+    // a voxel is set to anything else. `uniform_type` is only ever 
+    // `CHUNK_VOXEL_AIR` or `CHUNK_VOXEL_SOLID` outside of palette chunks.
+    bool uniform;
+    uint16_t uniform_type;
+    size_t row_words;     // CHUNK_STORAGE_BITS only 
+    uint64_t* bits;
+    struct ChunkPalette palette; // CHUNK_STORAGE_PALETTE only 
+
+    // Compressed chunks hold their voxels as `runs` instead of their 
+    // storage, which is restored as soon as a voxel is set.
+    bool compressed;
+    struct ChunkRuns runs;
+};
+
+/**
+ * Faces of a voxel, which double as the directions of the neighbors of a
+ * chunk. Arrays of neighboring chunks are indexed by this enum. The 
+ * order matches the layout of the voxel vertex template.
+ */
+enum ChunkFace {
+    CHUNK_FACE_NEG_Z = 0,
+    CHUNK_FACE_POS_X,
+    CHUNK_FACE_POS_Z,
+    CHUNK_FACE_NEG_X,
+    CHUNK_FACE_POS_Y,
+    CHUNK_FACE_NEG_Y,
+    CHUNK_FACE_COUNT,
 };
 
 struct vc__mesh_vertex {
@@ -29,25 +133,241 @@ struct vc__mesh_vertex {
     float z;
 } __attribute__((packed)); // we are copying bytes directly 
 
+/**
+ * Vertex data of a chunk mesh, as 32-bit scalars: three floats per vertex
+ * for `CHUNK_VERTEX_FLOAT3` meshes, one packed word per vertex for 
+ * `CHUNK_VERTEX_PACKED` meshes. `cap` and `len` count scalars.
+ */
 struct vc__float_verts_t {
     size_t cap;
     size_t len;
-    float* data;
+    union {
+        float* data;
+        uint32_t* packed;
+    };
+};
+
+/**
+ * Meshing strategies accepted by `ChunkMesh__from_chunk()`.
+ */
+enum ChunkMesher {
+    CHUNK_MESHER_NAIVE = 0, // every face of every enabled voxel 
+    CHUNK_MESHER_CULLED,    // only faces not hidden by a neighbor voxel 
+    CHUNK_MESHER_GREEDY,    // culled faces merged into maximal rectangles 
 };
 
+/**
+ * Vertex layouts a chunk mesh can be built with.
+ */
+enum ChunkVertexFormat {
+    CHUNK_VERTEX_FLOAT3 = 0, // scaled position as 3 floats 
+    CHUNK_VERTEX_PACKED,     // one 32-bit word, see CHUNK_PACKED_* 
+    CHUNK_VERTEX_INSTANCED,  // one record per face, see CHUNK_FACE_* 
+};
+
+/**
+ * Bit layout of a `CHUNK_VERTEX_PACKED` vertex, which must match 
+ * resources/default_vertex.glsl. Positions are unscaled chunk-local 
+ * vertex coordinates (0 to size inclusive), the face is an 
+ * `enum ChunkFace` (and thus the normal), AO ranges from 0 (fully 
+ * occluded) to 3 (unoccluded).
+ *
+ *  31      26 25 24 23  21 20    14 13     7 6      0
+ * [ material ][ ao ][face ][   z   ][   y   ][   x   ]
+ *
+ * The material is the low bits of the voxel type of the face's voxel.
+ */
+#define CHUNK_PACKED_X_SHIFT            0
+#define CHUNK_PACKED_Y_SHIFT            7
+#define CHUNK_PACKED_Z_SHIFT            14
+#define CHUNK_PACKED_FACE_SHIFT         21
+#define CHUNK_PACKED_AO_SHIFT           24
+#define CHUNK_PACKED_MATERIAL_SHIFT     26
+#define CHUNK_PACKED_MATERIAL_MASK      0x3F
+
+#define CHUNK_PACKED_MAX_SIZE           64 
+
+/**
+ * Layout of a `CHUNK_VERTEX_INSTANCED` face record, two 32-bit words 
+ * drawn as one instance of a 6-vertex quad. The first word is a packed 
+ * vertex holding the face's minimum corner (its AO bits unused), the 
+ * second holds the face's extent along each axis minus one (0 along the 
+ * axis of its normal) and the AO of its 4 corners, which are expanded 
+ * from the face in resources/default_vertex.glsl.
+ *
+ *  31      26 25 18 17  12 11   6 5    0
+ * [  unused  ][ ao ][ ez ][ ey ][ ex ]
+ */
+#define CHUNK_FACE_RECORD_WORDS         2
+#define CHUNK_FACE_EXTENT_X_SHIFT       0
+#define CHUNK_FACE_EXTENT_Y_SHIFT       6
+#define CHUNK_FACE_EXTENT_Z_SHIFT       12
+#define CHUNK_FACE_AO_SHIFT             18
+
+/**
+ * How `ChunkMesh__from_chunk()` builds a mesh. Zero-initialized options 
+ * select the naive mesher with float vertices.
+ *
+ * Indexed meshes store the 4 corners of every quad once and are drawn 
+ * with `glDrawElements()` through an element buffer shared by all chunk 
+ * meshes, instead of repeating 2 corners per quad. Instanced meshes 
+ * have no vertices to index and ignore it.
+ */
+struct ChunkMeshOptions {
+    enum ChunkMesher mesher;
+    enum ChunkVertexFormat format;
+    bool indexed;
+};
+
+/**
+ * Bookkeeping of which emitted face belongs to which voxel, so single 
+ * faces can be added and removed from a mesh. A face slot is the run of
+ * vertices of one face in `ChunkMesh.verts`; `owner[slot]` is 
+ * `voxel index * CHUNK_FACE_COUNT + face`, and `slot_of` is its inverse 
+ * (`VC__NO_SLOT` for faces that are not meshed).
+ */
+struct vc__face_slots_t {
+    size_t len;
+    uint32_t* owner;
+    uint32_t* slot_of;
+};
+
+#define VC__NO_SLOT UINT32_MAX
+
+struct vc__dirty_voxels_t {
+    size_t cap;
+    size_t len;
+    size_t* data;
+};
+
+/**
+ * Number of dirty voxels past which `ChunkMesh_flush_edits()` gives up
+ * on patching the mesh and rebuilds it from scratch.
+ */
+#ifndef CHUNK_MESH_MAX_INCREMENTAL_EDITS
+#define CHUNK_MESH_MAX_INCREMENTAL_EDITS 64
+#endif
+
 struct ChunkMesh {
     GLuint vao;
     GLuint vbo;
     struct vc__float_verts_t verts;
+
+    struct ChunkMeshOptions options;
+    size_t gpu_cap; // scalars allocated in `vbo` 
+    struct vc__face_slots_t slots; // only tracked after the first edit 
+    struct vc__dirty_voxels_t dirty;
+};
+
+struct vc__mesh_job_t;
+
+/**
+ * Meshes chunks on the workers of a `JobPool` and hands the finished 
+ * meshes back to the render thread, which does the GL upload. Like the
+ * pool, it is only handled through the pointer returned by 
+ * `ChunkMeshQueue__create()`.
+ */
+struct ChunkMeshQueue {
+    struct JobPool* pool;
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+
+    struct vc__mesh_job_t* done_head; // built, waiting to be polled
+    struct vc__mesh_job_t* done_tail;
+    size_t running; // submitted, not yet built 
+    size_t pending; // submitted, not yet polled 
 };
 
+/**
+ * A mesh returned by `ChunkMeshQueue_poll()`, along with the `user` 
+ * pointer it was submitted with.
+ */
+struct ChunkMeshResult {
+    struct ChunkMesh mesh;
+    void* user;
+};
+
+/**
+ * @brief Backs the voxel storage and mesh vertex buffers of every chunk 
+ * with huge pages if `hugepages` is set. Only takes effect before the 
+ * first chunk or mesh is created; afterwards the pool keeps its backing.
+ */
+void Chunk_init_buffers(bool hugepages);
+
+/**
+ * @brief Returns the pool shared by the voxel storage and mesh vertex 
+ * buffers of every chunk, e.g. for `BufferPool_stats()`.
+ */
+struct BufferPool* Chunk_buffer_pool(void);
+
 /** 
  * @brief Initialize an empty chunk of size `size`. The underlying
  * data must be freed via a call to `Chunk__destroy()` when this
- * chunk is no longer in use.
+ * chunk is no longer in use. Like every constructor below, the chunk 
+ * starts out uniform and only allocates its voxels once one is set.
  */
 struct Chunk Chunk__create(struct Size3D chunk_size);
 
+/** 
+ * @brief Initialize an empty `CHUNK_STORAGE_BITS` chunk of size `size`,
+ * to be destroyed with `Chunk_destroy()` like any other chunk.
+ */
+struct Chunk Chunk__create_bits(struct Size3D chunk_size);
+
+/** 
+ * @brief Initialize an all-air `CHUNK_STORAGE_PALETTE` chunk of size 
+ * `size`, to be destroyed with `Chunk_destroy()` like any other chunk.
+ */
+struct Chunk Chunk__create_palette(struct Size3D chunk_size);
+
+/** 
+ * @brief Initialize a chunk of size `size` entirely made of `type`, 
+ * which allocates no storage until a voxel is set to another type. 
+ * `storage` is the storage the chunk switches to at that point.
+ */
+struct Chunk Chunk__create_uniform(struct Size3D chunk_size, 
+                                   enum ChunkStorage storage, uint16_t type);
+
+/**
+ * Cube chunk sizes with specialized code paths, as X(size, log2 size). 
+ * Chunks of these sizes index linear storage with shifts and masks, and 
+ * the meshers run constant trip count loops over their rows. Chunks of 
+ * any other size take the generic paths. 
+ */
+#define CHUNK_FIXED_SIZES(X) \
+    X(16, 4) \
+    X(32, 5) \
+    X(64, 6)
+
+/**
+ * Defines, for a fixed chunk size `n`, `Chunk<n>__create()`, 
+ * `Chunk<n>__create_bits()` and `Chunk<n>__create_palette()`, as well 
+ * as linear index <-> position helpers `Chunk<n>_index()` and 
+ * `Chunk<n>_get_iaspos()` that never divide.
+ */
+#define CHUNK_DEFINE_FIXED(n, log2) \
+    static inline struct Chunk Chunk##n##__create(void) { \
+        return Chunk__create((struct Size3D){ n, n, n }); \
+    } \
+    static inline struct Chunk Chunk##n##__create_bits(void) { \
+        return Chunk__create_bits((struct Size3D){ n, n, n }); \
+    } \
+    static inline struct Chunk Chunk##n##__create_palette(void) { \
+        return Chunk__create_palette((struct Size3D){ n, n, n }); \
+    } \
+    static inline size_t Chunk##n##_index(uint32_t x, uint32_t y, \
+                                          uint32_t z) { \
+        return (size_t)x | (size_t)y << (log2) | (size_t)z << (2 * (log2)); \
+    } \
+    static inline struct Size3D Chunk##n##_get_iaspos(size_t idx) { \
+        return (struct Size3D){ \
+            (uint32_t)(idx & ((n) - 1)), \
+            (uint32_t)((idx >> (log2)) & ((n) - 1)), \
+            (uint32_t)(idx >> (2 * (log2))) }; \
+    }
+
+CHUNK_FIXED_SIZES(CHUNK_DEFINE_FIXED)
+
 /** 
  * @brief Destroys a chunk and frees internal resources. Since the 
  * encompassing `struct Chunk` type is not constructed via heap
@@ -56,25 +376,264 @@ struct Chunk Chunk__create(struct Size3D chunk_size);
  */
 void Chunk_destroy(struct Chunk* chunk);
 
+/**
+ * @brief Creates a deep copy of `chunk`, to be destroyed separately.
+ */
+struct Chunk Chunk__copy(const struct Chunk* chunk);
+
+/**
+ * @brief Reorders the voxels of `chunk` into `layout` in place. 
+ * @return false, leaving the chunk as is, if `chunk` cannot use `layout`.
+ */
+bool Chunk_set_layout(struct Chunk* chunk, enum ChunkLayout layout);
+
+/**
+ * @brief Interleaves the bits of `pos` into a Morton code (x lowest). 
+ * Each coordinate must fit in 21 bits.
+ */
+uint64_t Chunk_morton_encode(struct Size3D pos);
+
+/**
+ * @brief Inverse of `Chunk_morton_encode(struct Size3D)`.
+ */
+struct Size3D Chunk_morton_decode(uint64_t code);
+
+/**
+ * @brief Storage index of the voxel at `pos`, in the layout of `chunk`.
+ */
+size_t Chunk_index(const struct Chunk* chunk, struct Size3D pos);
+
 /**
  * @brief Computes the local (x, y, z) coordinates of a given index 
- * within this chunk. 
+ * within this chunk, in the layout of the chunk. 
  * @return The 3D cordinates, or {0, 0, 0} if idx is invalid.
  */ 
 struct Size3D Chunk_get_iaspos(struct Chunk* chunk, size_t idx);
 
+/**
+ * @brief Returns whether the voxel at `pos` is enabled. `pos` must be 
+ * within the chunk, as for every accessor below.
+ */
+bool Chunk_is_set(const struct Chunk* chunk, struct Size3D pos);
+
+/**
+ * @brief Returns the voxel type at `pos`.
+ */
+uint16_t Chunk_get_type(const struct Chunk* chunk, struct Size3D pos);
+
+/**
+ * @brief Sets the voxel type at `pos`, adding it to the palette of 
+ * palette chunks if needed. Other chunks only store whether the type is
+ * `CHUNK_VOXEL_AIR`.
+ */
+void Chunk_set_type(struct Chunk* chunk, struct Size3D pos, uint16_t type);
+
+/**
+ * @brief Enables the voxel at `pos`, as `CHUNK_VOXEL_SOLID` in palette 
+ * chunks.
+ */
+void Chunk_set(struct Chunk* chunk, struct Size3D pos);
+
+/**
+ * @brief Disables the voxel at `pos`.
+ */
+void Chunk_clear(struct Chunk* chunk, struct Size3D pos);
+
+/**
+ * @brief Sets the `len` voxels of `chunk` from index `idx` on in storage 
+ * order (see `Chunk_get_iaspos()`) to `type`, looking `type` up in the 
+ * palette once for the whole run.
+ */
+void Chunk_set_run(struct Chunk* chunk, size_t idx, size_t len, uint16_t type);
+
+/**
+ * @brief Run-length encodes the voxels of `chunk` in place, e.g. once it
+ * has gone unedited for a while. Reads keep working on the runs, a log 
+ * of the run count slower; the first write decompresses the chunk.
+ * @return Whether `chunk` was compressed, which it is not when the runs 
+ * would take more memory than its storage. Chunks made of a single run 
+ * become uniform instead.
+ */
+bool Chunk_compress(struct Chunk* chunk);
+
+/**
+ * @brief Restores the storage of a compressed `chunk`, doing nothing to
+ * other chunks.
+ */
+void Chunk_decompress(struct Chunk* chunk);
+
+/**
+ * @brief Bytes of voxel data held by `chunk`, not counting the palette 
+ * types and lookup nor the `struct Chunk` itself.
+ */
+size_t Chunk_storage_bytes(const struct Chunk* chunk);
+
+/**
+ * @brief Releases the storage of `chunk` if all its voxels are of the 
+ * same type, e.g. once a generator has filled it.
+ * @return Whether `chunk` is now uniform.
+ */
+bool Chunk_collapse(struct Chunk* chunk);
+
+/**
+ * @brief Returns the number of enabled voxels, a popcount over the 
+ * bitset of bit chunks.
+ */
+size_t Chunk_count_enabled(const struct Chunk* chunk);
+
+/**
+ * @brief Returns word `word` of row (y, z) of the chunk as laid out in 
+ * a bit chunk: bit `i` is the voxel at x = `word * 64 + i`. Bits past 
+ * the end of the row are 0.
+ */
+uint64_t Chunk_row(const struct Chunk* chunk, uint32_t y, uint32_t z, 
+                   size_t word);
+
+/**
+ * @brief Returns the number of enabled voxels in row (y, z).
+ */
+size_t Chunk_row_count(const struct Chunk* chunk, uint32_t y, uint32_t z);
+
+/**
+ * @brief Returns the column (x, z) of the chunk as a mask where bit `i` 
+ * is the voxel at y = `y0 + i`. Bits past the top of the chunk are 0.
+ */
+uint64_t Chunk_column(const struct Chunk* chunk, uint32_t x, uint32_t z, 
+                      uint32_t y0);
+
 /** 
- * @brief Generates a chunk mesh from `chunk`.
+ * @brief Generates a chunk mesh from `chunk` as described by `options`. 
+ * Culled and greedy meshes skip faces hidden by an enabled neighbor voxel;
+ * greedy meshes additionally merge coplanar faces into larger quads.
+ * Packed vertices are bound to attribute 1 and carry normals, ambient
+ * occlusion and the material of their voxel type (greedy quads then only
+ * merge faces of the same type); they require chunks of at most 
+ * `CHUNK_PACKED_MAX_SIZE` per axis and fall back to float vertices 
+ * (attribute 0) otherwise.
  * @returns `ChunkMesh` containing the chunk mesh VAO and VBO,
  * and other necessary metadata (if any).
  */
-struct ChunkMesh ChunkMesh__from_chunk(struct Chunk* chunk);
+struct ChunkMesh ChunkMesh__from_chunk(struct Chunk* chunk, 
+                                       struct ChunkMeshOptions options);
+
+/**
+ * @brief Generates a chunk mesh from `chunk` like `ChunkMesh__from_chunk()`,
+ * but also culls faces on the chunk border that are hidden by the 
+ * adjacent chunk. `neighbors` is indexed by `enum ChunkFace`, e.g. 
+ * `neighbors[CHUNK_FACE_POS_X]` is the chunk at +x. Neighbors may be NULL 
+ * (as may `neighbors` itself), in which case that side is treated as air.
+ * Neighbors must have the same size as `chunk` to be culled against.
+ */
+struct ChunkMesh ChunkMesh__from_chunk_neighbors(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options);
+
+/**
+ * @brief Builds the vertex data of a mesh like 
+ * `ChunkMesh__from_chunk_neighbors()`, without creating any GL objects.
+ * Makes no GL calls, so it may run on any thread; the mesh must be passed
+ * to `ChunkMesh_upload()` on the render thread before it is drawn.
+ */
+struct ChunkMesh ChunkMesh__build(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options);
+
+/**
+ * @brief Uploads the vertex data of `mesh` to the GPU, creating its VAO 
+ * and VBO if it has none yet.
+ */
+void ChunkMesh_upload(struct ChunkMesh* mesh);
+
+/**
+ * @brief Sets the voxel at `pos` of `chunk` (the chunk `mesh` was built
+ * from) and records it as dirty. The mesh is not touched until 
+ * `ChunkMesh_flush_edits()` is called, so many edits can be batched. 
+ * Edits on the chunk border also change the faces of the adjacent chunk,
+ * whose mesh must be edited (or rebuilt) separately.
+ */
+void ChunkMesh_edit_voxel(struct ChunkMesh* mesh, struct Chunk* chunk,
+                          struct Size3D pos, bool enabled);
+
+/**
+ * @brief Like `ChunkMesh_edit_voxel()`, but sets the voxel type at `pos`,
+ * so the material of its faces is updated as well.
+ */
+void ChunkMesh_edit_voxel_type(struct ChunkMesh* mesh, struct Chunk* chunk,
+                               struct Size3D pos, uint16_t type);
+
+/**
+ * @brief Applies the edits recorded by `ChunkMesh_edit_voxel()` to the 
+ * mesh and its GPU buffer. Culled meshes are patched in place: only the
+ * faces around dirty voxels are added or removed, and only the touched
+ * range of the vertex buffer is re-uploaded. Other meshers, and batches 
+ * of more than `CHUNK_MESH_MAX_INCREMENTAL_EDITS` voxels, fall back to a 
+ * full rebuild. `neighbors` is as in `ChunkMesh__from_chunk_neighbors()`.
+ */
+void ChunkMesh_flush_edits(struct ChunkMesh* mesh, struct Chunk* chunk,
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT]);
+
+/**
+ * @brief Frees the vertex data, edit bookkeeping and GL objects of `mesh`.
+ */
+void ChunkMesh_destroy(struct ChunkMesh* mesh);
+
+/**
+ * @brief returns the number of vertices stored in this chunk mesh, i.e. 
+ * the count to pass to `glDrawArrays()` for non-indexed meshes. For 
+ * instanced meshes, this is the number of vertices expanded from the 
+ * face records.
+ */ 
+size_t ChunkMesh_vertex_count(struct ChunkMesh* mesh);
 
 /**
  * @brief returns the number of polygons in this chunk mesh.
- * Internally returns mesh->verts.len, but this is used in 
- * case of implementation change as well as for brevity.
  */ 
 size_t ChunkMesh_polygon_count(struct ChunkMesh* mesh);
 
+/**
+ * @brief Binds the VAO of `mesh` and draws it, with `glDrawElements()` 
+ * for indexed meshes, `glDrawArraysInstanced()` for instanced meshes 
+ * and `glDrawArrays()` otherwise. The shader program must already be 
+ * in use.
+ */
+void ChunkMesh_draw(struct ChunkMesh* mesh);
+
+/**
+ * @brief Creates a queue meshing chunks on the workers of `pool`, which 
+ * must outlive it.
+ */
+struct ChunkMeshQueue* ChunkMeshQueue__create(struct JobPool* pool);
+
+/**
+ * @brief Queues `chunk` to be meshed with `options` on a worker. `chunk`
+ * and `neighbors` (as in `ChunkMesh__from_chunk_neighbors()`) are copied,
+ * so they may be edited or destroyed right away. `user` is handed back
+ * with the mesh.
+ */
+void ChunkMeshQueue_submit(struct ChunkMeshQueue* queue, 
+                           const struct Chunk* chunk, 
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+                           struct ChunkMeshOptions options, void* user);
+
+/**
+ * @brief Uploads up to `max` finished meshes, in the order they finished,
+ * and writes them to `results`. Must be called on the render thread; 
+ * `max` bounds the upload work done per call (e.g. per frame). Never 
+ * waits for a worker.
+ * @returns The number of meshes written to `results`.
+ */
+size_t ChunkMeshQueue_poll(struct ChunkMeshQueue* queue, 
+                           struct ChunkMeshResult* results, size_t max);
+
+/**
+ * @brief Returns the number of submitted meshes not yet polled.
+ */
+size_t ChunkMeshQueue_pending(struct ChunkMeshQueue* queue);
+
+/**
+ * @brief Waits for the meshes still being built, discards every mesh 
+ * that was not polled and frees `queue`.
+ */
+void ChunkMeshQueue_destroy(struct ChunkMeshQueue* queue);
+
 #endif 
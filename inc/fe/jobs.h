@@ -0,0 +1,66 @@
+#ifndef FE_JOBS_H
+#define FE_JOBS_H
+
+#include <pthread.h>
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+/**
+ * A unit of work run on a pool thread. `arg` is owned by the submitter.
+ */
+struct Job {
+    void (*run)(void* arg);
+    void* arg;
+};
+
+struct fe__job_queue_t {
+    size_t cap;
+    size_t head;
+    size_t len;
+    struct Job* data;
+};
+
+/**
+ * A fixed set of worker threads running submitted jobs in FIFO order.
+ * Jobs must not touch OpenGL, which is only current on the main thread.
+ * The pool holds its own synchronization primitives, so it is always
+ * handled through the pointer returned by `JobPool__create()`.
+ */
+struct JobPool {
+    pthread_mutex_t lock;
+    pthread_cond_t has_work;
+    pthread_cond_t idle;
+
+    struct fe__job_queue_t queue;
+    size_t running;
+    bool stopping;
+
+    size_t thread_count;
+    pthread_t* threads;
+};
+
+/**
+ * @brief Starts a pool of `thread_count` workers, or one per online CPU
+ * core when `thread_count` is 0.
+ */
+struct JobPool* JobPool__create(size_t thread_count);
+
+/**
+ * @brief Queues `run(arg)` to be run on a worker. Never blocks on other
+ * jobs.
+ */
+void JobPool_submit(struct JobPool* pool, void (*run)(void* arg), void* arg);
+
+/**
+ * @brief Blocks until every job submitted so far has finished.
+ */
+void JobPool_wait(struct JobPool* pool);
+
+/**
+ * @brief Finishes every queued job, then joins the workers and frees
+ * `pool`.
+ */
+void JobPool_destroy(struct JobPool* pool);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef FE_NOISE_H
+#define FE_NOISE_H
+
+#include <fe/geometries/vchunk.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * Instruction sets the batched noise functions can run on, from slowest
+ * to fastest. Lanes compute exactly what `noise3()` of noise1234 does, in
+ * the same order, so every set gives the same results as the scalar code
+ * up to rounding of the compiler's choosing (in practice, bit for bit).
+ */
+enum NoiseIsa {
+    NOISE_ISA_SCALAR = 0,
+    NOISE_ISA_SSE41,  // 4 lanes
+    NOISE_ISA_AVX2,   // 8 lanes, with gathers for the permutation lookups
+};
+
+/**
+ * Noise functions a density field can be built on. Perlin noise is 
+ * noise1234's `noise3()` and `noise4()`, with SIMD batches in 3D. Simplex
+ * noise blends the 3 corners of a triangle in 2D, 4 of a tetrahedron in 
+ * 3D and 5 of a 4D simplex where Perlin noise blends 4, 8 and 16 corners
+ * of a cube, so it is much cheaper in 4D (e.g. animated 3D noise) and 
+ * has no axis-aligned artifacts. Both range over about [-1, 1].
+ */
+enum NoiseBackend {
+    NOISE_BACKEND_PERLIN = 0,
+    NOISE_BACKEND_SIMPLEX,
+};
+
+/**
+ * @brief Simplex noise in 2D, 3D and 4D, over the same permutation and
+ * gradients as noise1234.
+ */
+float simplex2(float x, float y);
+float simplex3(float x, float y, float z);
+float simplex4(float x, float y, float z, float w);
+
+/**
+ * @brief Returns the instruction set the batched noise functions use,
+ * the fastest one the CPU supports unless forced otherwise.
+ */
+enum NoiseIsa noise_isa(void);
+
+/**
+ * @brief Makes the batched noise functions use `isa`, or the fastest
+ * supported set below it, e.g. to compare them.
+ * @return The set actually used.
+ */
+enum NoiseIsa noise_force_isa(enum NoiseIsa isa);
+
+/**
+ * @brief Sets `out[i]` to `noise3(x[i], y[i], z[i])` for the `n` points.
+ */
+void noise3_batch(const float* x, const float* y, const float* z, float* out,
+                  size_t n);
+
+/**
+ * @brief Samples `noise3()` over the lattice of `xs[i]`, `ys[j]` and
+ * `zs[k]` for i, j and k below `size.x`, `size.y` and `size.z`. `out`
+ * receives the samples x first, i.e. sample (i, j, k) at
+ * `i + j * size.x + k * size.x * size.y`.
+ */
+void noise3_grid(float* out, struct Size3D size, const float* xs,
+                 const float* ys, const float* zs);
+
+/**
+ * @brief Like `noise3_grid()`, with `noise4()` at a fixed `w`.
+ */
+void noise4_grid(float* out, struct Size3D size, const float* xs,
+                 const float* ys, const float* zs, float w);
+
+/**
+ * @brief Like `noise3_grid()` and `noise4_grid()`, with simplex noise.
+ */
+void simplex3_grid(float* out, struct Size3D size, const float* xs,
+                   const float* ys, const float* zs);
+void simplex4_grid(float* out, struct Size3D size, const float* xs,
+                   const float* ys, const float* zs, float w);
+
+#endif
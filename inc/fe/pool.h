@@ -0,0 +1,154 @@
+#ifndef FE_POOL_H
+#define FE_POOL_H
+
+#include <pthread.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Slabs are reserved in multiples of a huge page, so that they can be
+// backed by one when huge pages are enabled.
+#define FE_POOL_SLAB_BYTES ((size_t)2 << 20)
+
+// Size classes of `struct BufferPool` go 256, 384, 512, 768, ... up to
+// 4 MiB, so that no block wastes more than a third of itself. Larger
+// buffers fall back to malloc.
+#define FE_POOL_MIN_CLASS_LOG2 8
+#define FE_POOL_MAX_CLASS_LOG2 22
+#define FE_POOL_CLASS_COUNT \
+    (2 * (FE_POOL_MAX_CLASS_LOG2 - FE_POOL_MIN_CLASS_LOG2) + 1)
+
+/**
+ * Occupancy of a pool. Reserved bytes are what the pool holds from the
+ * system, used bytes what it has handed out, and requested bytes what
+ * callers asked for, so that used - requested is the waste to rounding
+ * up to block sizes and reserved - used the blocks waiting for reuse.
+ */
+struct PoolStats {
+    size_t slabs;
+    size_t huge_slabs; // slabs backed by (or advised to use) huge pages
+    size_t reserved_bytes;
+    size_t used_bytes;
+    size_t requested_bytes;
+    size_t used_blocks;
+    size_t allocs; // over the lifetime of the pool
+    size_t frees;
+};
+
+struct fe__slab_t {
+    void* base;
+    size_t bytes;
+};
+
+/**
+ * Blocks of a single size carved out of large slabs. Freed blocks are
+ * kept on an intrusive free list and handed out again before the slab is
+ * bumped further; slabs are only returned to the system when the pool
+ * is destroyed, so steady churn never fragments the heap. Pools are
+ * thread safe and hold their own lock, so they are handled by pointer.
+ */
+struct SlabPool {
+    pthread_mutex_t lock;
+    size_t block_size;
+    size_t slab_bytes;
+    bool hugepages;
+
+    void* free_list;
+    char* bump;
+    char* bump_end;
+
+    struct fe__slab_t* slabs;
+    size_t slab_cap;
+
+    struct PoolStats stats;
+};
+
+/**
+ * Variable size buffers served from a `struct SlabPool` per size class.
+ * Callers pass the size of a buffer back when freeing or resizing it,
+ * so blocks carry no header.
+ */
+struct BufferPool {
+    struct SlabPool classes[FE_POOL_CLASS_COUNT];
+
+    pthread_mutex_t large_lock;
+    struct PoolStats large; // buffers past the largest class
+};
+
+/**
+ * @brief Creates a pool of `block_size` byte blocks (at least
+ * `sizeof (void*)`), optionally backed by huge pages.
+ */
+struct SlabPool* SlabPool__create(size_t block_size, bool hugepages);
+
+/**
+ * @brief Returns an uninitialized block of the pool.
+ */
+void* SlabPool_alloc(struct SlabPool* pool);
+
+/**
+ * @brief Returns `block`, allocated from `pool`, to `pool`.
+ */
+void SlabPool_free(struct SlabPool* pool, void* block);
+
+/**
+ * @brief Copies the occupancy statistics of `pool`.
+ */
+struct PoolStats SlabPool_stats(struct SlabPool* pool);
+
+/**
+ * @brief Returns every slab of `pool` to the system. Blocks still in use
+ * become invalid.
+ */
+void SlabPool_destroy(struct SlabPool* pool);
+
+/**
+ * @brief Creates a size classed pool, optionally backed by huge pages.
+ */
+struct BufferPool* BufferPool__create(bool hugepages);
+
+/**
+ * @brief Returns the number of bytes actually reserved for a buffer of
+ * `bytes` bytes. Callers may use the whole of it.
+ */
+size_t BufferPool_usable(size_t bytes);
+
+/**
+ * @brief Returns an uninitialized buffer of at least `bytes` bytes, or
+ * NULL if `bytes` is 0.
+ */
+void* BufferPool_alloc(struct BufferPool* pool, size_t bytes);
+
+/**
+ * @brief Returns a zeroed buffer of at least `bytes` bytes, or NULL if
+ * `bytes` is 0.
+ */
+void* BufferPool_calloc(struct BufferPool* pool, size_t bytes);
+
+/**
+ * @brief Resizes `data`, a buffer of `bytes` bytes, to `new_bytes` bytes,
+ * keeping its contents. Buffers only move when their size class changes.
+ */
+void* BufferPool_realloc(struct BufferPool* pool, void* data, size_t bytes,
+                         size_t new_bytes);
+
+/**
+ * @brief Returns `data`, a buffer allocated with `bytes` bytes, to
+ * `pool`. NULL is ignored.
+ */
+void BufferPool_free(struct BufferPool* pool, void* data, size_t bytes);
+
+/**
+ * @brief Returns the statistics of `pool` summed over every class, and
+ * fills `classes` with those of each class unless it is NULL.
+ */
+struct PoolStats BufferPool_stats(struct BufferPool* pool,
+                                  struct PoolStats classes[FE_POOL_CLASS_COUNT]);
+
+/**
+ * @brief Returns every slab of `pool` to the system and frees it.
+ */
+void BufferPool_destroy(struct BufferPool* pool);
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef FE_REGION_H
+#define FE_REGION_H
+
+#include <fe/world.h>
+#include <fe/geometries/vchunk.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// A region file holds the chunks of FE_REGION_SIZE x FE_REGION_SIZE chunk
+// columns, FE_REGION_HEIGHT chunks tall.
+#define FE_REGION_SIZE 32
+#define FE_REGION_HEIGHT 16
+#define FE_REGION_CHUNKS (FE_REGION_SIZE * FE_REGION_SIZE * FE_REGION_HEIGHT)
+
+#define FE_REGION_MAGIC "FERG"
+#define FE_REGION_VERSION 1
+
+// Regions are compacted once dead payloads outweigh live ones and take
+// at least this many bytes.
+#define FE_REGION_COMPACT_MIN_BYTES ((size_t)1 << 20)
+
+// open regions kept by a `struct RegionStore`
+#define FE_REGION_MAX_OPEN 8
+
+struct fe__region_entry_t {
+    uint32_t offset; // of the payload in the file, 0 if the chunk is absent
+    uint32_t bytes;
+};
+
+/**
+ * Start of every region file, followed by the chunk payloads in the order
+ * they were written. Payloads are never overwritten: saving a chunk again
+ * appends it and points its entry at the new copy. Fields are in host
+ * byte order.
+ */
+struct fe__region_header_t {
+    char magic[4];
+    uint32_t version;
+    uint32_t chunk_size[3];
+    uint32_t generator; // tag of what the chunks were generated by
+    uint64_t live_bytes; // payload bytes pointed at by an entry
+    struct fe__region_entry_t entries[FE_REGION_CHUNKS];
+};
+
+/**
+ * A region file, mapped for reads. Chunks are indexed by their position
+ * within the region, see `Region_index()`.
+ */
+struct Region {
+    char* path;
+    int fd;
+    struct Size3D chunk_size;
+    uint32_t generator;
+
+    uint8_t* map; // the whole file as of the last remap, header first
+    size_t map_bytes;
+    size_t file_bytes;
+};
+
+/**
+ * Region files of a directory, opened on demand. Chunks are addressed by
+ * their world coordinates; the region of chunk (x, y, z) is stored as
+ * `r.<x>.<y>.<z>.fer` with the coordinates divided (rounding down) by the
+ * region size. Stores are not thread safe.
+ */
+struct RegionStore {
+    char* dir;
+    struct Size3D chunk_size;
+    uint32_t generator;
+
+    struct {
+        struct ChunkCoord coord;
+        struct Region* region;
+        uint64_t used;
+    } open[FE_REGION_MAX_OPEN];
+    size_t open_count;
+    uint64_t tick;
+};
+
+/**
+ * @brief Opens the region file at `path` holding chunks of `chunk_size`,
+ * creating it if it does not exist. `generator` tags what produced the
+ * chunks, e.g. a hash of the terrain parameters: a region saved under
+ * another tag is stale, so its chunks are discarded and the file starts
+ * over empty.
+ * @return NULL, after logging why, if the file cannot be opened or is not
+ * a region of `chunk_size` chunks.
+ */
+struct Region* Region__open(const char* path, struct Size3D chunk_size,
+                            uint32_t generator);
+
+/**
+ * @brief Index within its region of the chunk at `coord`, in world chunk
+ * coordinates.
+ */
+size_t Region_index(struct ChunkCoord coord);
+
+/**
+ * @brief Whether the chunk at `index` was saved to `region`.
+ */
+bool Region_contains(const struct Region* region, size_t index);
+
+/**
+ * @brief Decodes the chunk at `index` of `region` into `chunk`, to be
+ * destroyed by the caller.
+ * @return false if the chunk is absent or its payload is corrupt.
+ */
+bool Region_load(struct Region* region, size_t index, struct Chunk* chunk);
+
+/**
+ * @brief Run-length encodes `chunk` and appends it to `region` as the
+ * chunk at `index`, compacting the file if it has become mostly dead
+ * payloads.
+ * @return false, leaving the region as it was, if the write failed.
+ */
+bool Region_save(struct Region* region, size_t index,
+                 const struct Chunk* chunk);
+
+/**
+ * @brief Rewrites `region` with only its live payloads, through a
+ * temporary file renamed over it.
+ */
+bool Region_compact(struct Region* region);
+
+/**
+ * @brief Flushes `region` to disk.
+ */
+void Region_sync(struct Region* region);
+
+/**
+ * @brief Flushes and closes `region`.
+ */
+void Region_close(struct Region* region);
+
+/**
+ * @brief Creates a store of the regions of `dir`, creating the directory
+ * if needed, to be destroyed with `RegionStore_destroy()`. Regions saved
+ * under a `generator` other than this one are discarded on open, see
+ * `Region__open()`.
+ */
+struct RegionStore RegionStore__create(const char* dir,
+                                       struct Size3D chunk_size,
+                                       uint32_t generator);
+
+/**
+ * @brief Loads the chunk at `coord` into `chunk`.
+ * @return false if it was never saved.
+ */
+bool RegionStore_load(struct RegionStore* store, struct ChunkCoord coord,
+                      struct Chunk* chunk);
+
+/**
+ * @brief Saves `chunk` as the chunk at `coord`, replacing any earlier one.
+ */
+bool RegionStore_save(struct RegionStore* store, struct ChunkCoord coord,
+                      const struct Chunk* chunk);
+
+/**
+ * @brief Flushes every open region of `store` to disk.
+ */
+void RegionStore_sync(struct RegionStore* store);
+
+/**
+ * @brief Closes every region of `store` and frees it.
+ */
+void RegionStore_destroy(struct RegionStore* store);
+
+#endif
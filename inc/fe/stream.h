@@ -0,0 +1,196 @@
+#ifndef FE_STREAM_H
+#define FE_STREAM_H
+
+#include <fe/world.h>
+#include <fe/geometries/vchunk.h>
+#include <fe/jobs.h>
+
+#include <pthread.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Generates the chunk at `coord`, of the chunk size of the world it is
+ * streamed into. Called on the thread running `ChunkStream_update()`, or
+ * concurrently on the workers of a `struct ChunkGenerateQueue`, in which
+ * case it must be thread safe. Worlds only come out the same whatever
+ * the number of workers and the order they finish in if the chunk only
+ * depends on `coord`.
+ */
+typedef struct Chunk (*ChunkGenerateFn)(struct ChunkCoord coord, void* user);
+
+struct fe__generate_job_t;
+
+/**
+ * Generates chunks on the workers of a `JobPool` and hands them back to
+ * the thread owning the world, which only has to insert them. Like the
+ * pool, it is only handled through the pointer returned by
+ * `ChunkGenerateQueue__create()`.
+ */
+struct ChunkGenerateQueue {
+    struct JobPool* pool;
+    ChunkGenerateFn generate;
+    void* user;
+
+    pthread_mutex_t lock;
+    pthread_cond_t finished;
+
+    struct fe__generate_job_t* done_head; // generated, waiting to be polled
+    struct fe__generate_job_t* done_tail;
+    size_t running; // submitted, not yet generated
+    size_t pending; // submitted, not yet polled
+};
+
+/**
+ * A chunk returned by `ChunkGenerateQueue_poll()`, now owned by the
+ * caller.
+ */
+struct ChunkGenerateResult {
+    struct ChunkCoord coord;
+    struct Chunk chunk;
+};
+
+struct ChunkStreamOptions {
+    // Chunks whose center lies within `load_radius` chunks of the camera
+    // are loaded; loaded chunks are only unloaded past `unload_radius`,
+    // which must be larger, so that chunks at the edge do not thrash
+    // while the camera moves back and forth.
+    int32_t load_radius;
+    int32_t unload_radius;
+
+    // per `ChunkStream_update()` call, to bound the time spent per frame
+    size_t max_loads;
+    size_t max_meshing; // meshes in flight on the pool at once
+
+    // Chunks generated on the pool at once. Loads are generated on the 
+    // pool whenever this is set, and inline by `ChunkStream_update()` 
+    // otherwise.
+    size_t max_generating;
+
+    // Meshed chunks are run-length compressed (see `Chunk_compress()`) 
+    // once they lie past `compress_radius` chunks from the camera, or have
+    // gone `compress_idle` updates without being generated, meshed or 
+    // edited; 0 disables either rule. Up to `max_compress` loaded chunks 
+    // are looked at per update, in a sweep that resumes where it stopped.
+    int32_t compress_radius;
+    uint32_t compress_idle;
+    size_t max_compress;
+
+    struct ChunkMeshOptions mesh_options;
+    ChunkGenerateFn generate;
+    void* user;
+};
+
+struct fe__stream_offset_t {
+    struct ChunkCoord offset;
+    float distance; // in chunks
+};
+
+struct fe__stream_pick_t {
+    struct ChunkCoord coord;
+    float priority; // lower first
+};
+
+/**
+ * Keeps the chunks around the camera loaded into a `struct World` and
+ * meshed. Missing chunks are generated and meshed nearest first, with
+ * chunks in front of the camera preferred over chunks behind it at the
+ * same distance. A chunk is only meshed once its neighbors within the
+ * load radius are loaded, so that it culls against them, and is meshed
+ * again when a neighbor shows up later.
+ *
+ * Chunks generated on the pool are held in the world by an air 
+ * placeholder flagged `generating` until they are polled, so that they 
+ * are neither loaded twice nor meshed against. Placeholders may be 
+ * unloaded, their chunk is then dropped when it comes back.
+ *
+ * The stream owns the mesh queue of the world; entries of the world are
+ * meshed, polled and unloaded only through `ChunkStream_update()`.
+ */
+struct ChunkStream {
+    struct World* world;
+    struct ChunkMeshQueue* queue;
+    struct ChunkGenerateQueue* generate_queue; // NULL without `max_generating`
+    struct ChunkStreamOptions options;
+
+    // offsets within the load radius, nearest first
+    struct fe__stream_offset_t* offsets;
+    size_t offset_count;
+
+    struct ChunkCoord center;
+    bool centered;
+    bool settled; // everything around `center` is loaded and meshed
+
+    uint64_t tick; // `ChunkStream_update()` calls so far
+    size_t compress_cursor;
+
+    // scratch space reused across updates
+    struct fe__stream_pick_t* picks;
+    struct ChunkCoord* unloads;
+    size_t unloads_cap;
+};
+
+/**
+ * @brief Creates a queue generating chunks with `generate(coord, user)` 
+ * on the workers of `pool`, which must outlive it.
+ */
+struct ChunkGenerateQueue* ChunkGenerateQueue__create(struct JobPool* pool,
+                                                      ChunkGenerateFn generate,
+                                                      void* user);
+
+/**
+ * @brief Queues the chunk at `coord` to be generated on a worker.
+ */
+void ChunkGenerateQueue_submit(struct ChunkGenerateQueue* queue,
+                               struct ChunkCoord coord);
+
+/**
+ * @brief Writes up to `max` generated chunks to `results`, in the order 
+ * they finished. Never waits for a worker.
+ * @returns The number of chunks written to `results`.
+ */
+size_t ChunkGenerateQueue_poll(struct ChunkGenerateQueue* queue,
+                               struct ChunkGenerateResult* results, 
+                               size_t max);
+
+/**
+ * @brief Returns the number of submitted chunks not yet polled.
+ */
+size_t ChunkGenerateQueue_pending(struct ChunkGenerateQueue* queue);
+
+/**
+ * @brief Waits for the chunks still being generated, destroys every 
+ * chunk that was not polled and frees `queue`.
+ */
+void ChunkGenerateQueue_destroy(struct ChunkGenerateQueue* queue);
+
+/**
+ * @brief Creates a stream loading chunks into `world` and generating and
+ * meshing them on `pool`, to be destroyed with `ChunkStream_destroy()` 
+ * before `world`.
+ */
+struct ChunkStream ChunkStream__create(struct World* world,
+                                       struct JobPool* pool,
+                                       struct ChunkStreamOptions options);
+
+/**
+ * @brief Polls finished meshes, unloads chunks past the unload radius,
+ * and generates and submits for meshing the most urgent chunks around
+ * `camera_pos`, facing `camera_front`. Both are in voxels, in world
+ * space. Cold chunks are then compressed as set by the
+ * `ChunkStreamOptions`. Must be called from the thread owning the OpenGL
+ * context.
+ */
+void ChunkStream_update(struct ChunkStream* stream, const float camera_pos[3],
+                        const float camera_front[3]);
+
+/**
+ * @brief Waits for and discards the meshes and chunks still in flight and
+ * frees the stream. Chunks already loaded stay in the world, placeholders
+ * are removed.
+ */
+void ChunkStream_destroy(struct ChunkStream* stream);
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef FE_WORLD_H
+#define FE_WORLD_H
+
+#include <fe/geometries/vchunk.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Integer coordinates of a chunk in the world, in chunks. Each component
+ * must fit in 21 bits signed, i.e. [-2^20, 2^20).
+ */
+struct ChunkCoord {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+};
+
+/**
+ * A chunk owned by a `struct World`, along with its mesh once one has
+ * been built. Entries are heap-allocated so pointers to them stay valid
+ * until they are removed, and can be handed to `ChunkMeshQueue_submit()`
+ * as the `user` pointer.
+ */
+struct WorldChunk {
+    struct ChunkCoord coord;
+    struct Chunk chunk;
+    struct ChunkMesh mesh;
+    bool meshed;
+    bool meshing; // submitted to a mesh queue, must not be removed 
+    bool stale;   // `mesh` predates a change of the chunk or its neighbors
+    bool generating; // `chunk` is an air placeholder for one being generated
+
+    // Kept by `struct ChunkStream` to decide when to compress `chunk`: the 
+    // update that last generated or meshed it or saw it edited, whether 
+    // it has since been compressed (or found not worth it), and whether 
+    // that left it compressed or uniform.
+    uint64_t used;
+    bool cold;
+    bool compact;
+};
+
+struct fe__world_slot_t {
+    uint64_t key; // packed `struct ChunkCoord`, compared before `entry`
+    struct WorldChunk* entry; // NULL if the slot is empty
+};
+
+/**
+ * Chunks of a world keyed by their `struct ChunkCoord`, in an open
+ * addressing hash table with linear probing. Slots hold the packed
+ * coordinates inline, so a lookup only touches contiguous slots until it
+ * hits its entry. Removal shifts the following slots back instead of
+ * leaving tombstones, so probe sequences never grow with churn.
+ *
+ * The world is only meant to be used from the main thread, since
+ * removing a chunk destroys its mesh.
+ */
+struct World {
+    struct Size3D chunk_size;
+    size_t cap; // a power of two, or 0
+    size_t len;
+    struct fe__world_slot_t* slots;
+};
+
+/**
+ * @brief Creates an empty world of chunks of `chunk_size` voxels, to be
+ * destroyed with `World_destroy()`.
+ */
+struct World World__create(struct Size3D chunk_size);
+
+/**
+ * @brief Destroys every chunk and mesh of `world` and frees the table.
+ */
+void World_destroy(struct World* world);
+
+/**
+ * @brief Moves `chunk` into `world` at `coord`, replacing (and
+ * destroying) the chunk and mesh already there, if any.
+ * @return The entry of `coord`, valid until it is removed.
+ */
+struct WorldChunk* World_insert(struct World* world, struct ChunkCoord coord,
+                                struct Chunk chunk);
+
+/**
+ * @brief Returns the entry at `coord`, or NULL if there is none.
+ */
+struct WorldChunk* World_get(const struct World* world, struct ChunkCoord coord);
+
+/**
+ * @brief Destroys the chunk and mesh at `coord`.
+ * @return false if there was no chunk at `coord`, or if it is being 
+ * meshed and cannot be removed yet.
+ */
+bool World_remove(struct World* world, struct ChunkCoord coord);
+
+/**
+ * @brief Fills `neighbors`, indexed by `enum ChunkFace`, with the chunks
+ * adjacent to `coord`, or NULL where there is none. The result can be
+ * passed as is to the meshers.
+ */
+void World_neighbors(const struct World* world, struct ChunkCoord coord,
+                     struct Chunk* neighbors[CHUNK_FACE_COUNT]);
+
+/**
+ * @brief Iterates over the entries of `world` in table order. `*cursor`
+ * must start at 0. Inserting or removing chunks invalidates the cursor.
+ * @return The next entry, or NULL once every entry has been visited.
+ */
+struct WorldChunk* World_next(const struct World* world, size_t* cursor);
+
+/**
+ * @brief Returns the number of chunks in `world`.
+ */
+size_t World_count(const struct World* world);
+
+/**
+ * @brief Position of the minimum corner of the chunk at `coord`, in 
+ * voxels. Mesh positions are in voxels times the scale of the chunk.
+ */
+struct ChunkCoord World_chunk_origin(const struct World* world,
+                                     struct ChunkCoord coord);
+
+#endif
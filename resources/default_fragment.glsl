@@ -3,14 +3,25 @@ out vec4 FragColor;
 
 in vec3 FragPos;
 in vec3 Normal;
+in float Occlusion;
+flat in uint Material;
 
 uniform vec3 u_lightpos;
 
+// indexed by material, i.e. the low 6 bits of the voxel type; materials 
+// past the table reuse its colors 
+const vec3 MATERIAL_COLORS[4] = vec3[4](
+    vec3(0.35f, 0.35f, 0.35f),
+    vec3(0.40f, 0.40f, 0.42f),
+    vec3(0.45f, 0.32f, 0.22f),
+    vec3(0.30f, 0.50f, 0.25f)
+);
+
 void main() {
     vec3 light_color = vec3(1.0f, 1.0f, 1.0f);
-    vec3 object_color = vec3(0.35f, 0.35f, 0.35f);
+    vec3 object_color = MATERIAL_COLORS[Material % 4u];
 
-    float ambient_strength = 0.4;
+    float ambient_strength = 0.4 * (0.5 + 0.5 * Occlusion);
     vec3 ambient = ambient_strength * light_color;
 
     vec3 norm = normalize(Normal);
@@ -1,13 +1,75 @@
 #version 330 core 
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in uint aPacked; // see CHUNK_PACKED_* in vchunk.h
+layout (location = 2) in uvec2 aFace;  // see CHUNK_FACE_* in vchunk.h
 
 out vec3 FragPos; // not yet needed as the chunk isnt moving 
 out vec3 Normal;
+out float Occlusion;
+flat out uint Material;
 
 uniform mat4 u_transform; 
+uniform int u_format; // `enum ChunkVertexFormat` of the mesh 
+uniform float u_scale; // packed positions are unscaled 
+uniform vec3 u_chunk_origin; // world position of the chunk, in voxels 
+
+const int FORMAT_FLOAT3 = 0;
+const int FORMAT_PACKED = 1;
+const int FORMAT_INSTANCED = 2;
+
+// indexed by `enum ChunkFace` 
+const vec3 FACE_NORMALS[6] = vec3[6](
+    vec3( 0.0,  0.0, -1.0),
+    vec3( 1.0,  0.0,  0.0),
+    vec3( 0.0,  0.0,  1.0),
+    vec3(-1.0,  0.0,  0.0),
+    vec3( 0.0,  1.0,  0.0),
+    vec3( 0.0, -1.0,  0.0)
+);
+
+// corners of the unit quad of each face, 4 per `enum ChunkFace`, in the
+// order of the face vertex template in vchunk.c 
+const vec3 FACE_CORNERS[24] = vec3[24](
+    vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 0, 0), vec3(0, 0, 0),
+    vec3(1, 1, 0), vec3(1, 1, 1), vec3(1, 0, 1), vec3(1, 0, 0),
+    vec3(1, 1, 1), vec3(0, 1, 1), vec3(0, 0, 1), vec3(1, 0, 1),
+    vec3(0, 1, 1), vec3(0, 1, 0), vec3(0, 0, 0), vec3(0, 0, 1),
+    vec3(0, 1, 1), vec3(1, 1, 1), vec3(1, 1, 0), vec3(0, 1, 0),
+    vec3(0, 0, 1), vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1)
+);
+
+// the two triangles of a quad 
+const int QUAD_INDICES[6] = int[6](0, 1, 2, 2, 3, 0);
 
 void main() { 
-    gl_Position = u_transform * vec4(aPos, 1.0);
+    vec3 pos = aPos;
     Normal = aPos;
-    FragPos = aPos;
+    Occlusion = 1.0;
+    Material = 0u;
+
+    if (u_format == FORMAT_PACKED) {
+        pos = vec3(aPacked & 0x7Fu, 
+                   (aPacked >> 7u) & 0x7Fu, 
+                   (aPacked >> 14u) & 0x7Fu) * u_scale;
+        Normal = FACE_NORMALS[int((aPacked >> 21u) & 0x7u)];
+        Occlusion = float((aPacked >> 24u) & 0x3u) / 3.0;
+        Material = aPacked >> 26u;
+    } else if (u_format == FORMAT_INSTANCED) {
+        int face = int((aFace.x >> 21u) & 0x7u);
+        int corner = QUAD_INDICES[gl_VertexID];
+        vec3 origin = vec3(aFace.x & 0x7Fu, 
+                           (aFace.x >> 7u) & 0x7Fu, 
+                           (aFace.x >> 14u) & 0x7Fu);
+        vec3 extent = vec3(aFace.y & 0x3Fu, 
+                           (aFace.y >> 6u) & 0x3Fu, 
+                           (aFace.y >> 12u) & 0x3Fu) + 1.0;
+        pos = (origin + FACE_CORNERS[face * 4 + corner] * extent) * u_scale;
+        Normal = FACE_NORMALS[face];
+        Occlusion = float((aFace.y >> uint(18 + 2 * corner)) & 0x3u) / 3.0;
+        Material = aFace.x >> 26u;
+    }
+
+    pos += u_chunk_origin * u_scale;
+    gl_Position = u_transform * vec4(pos, 1.0);
+    FragPos = pos;
 } 
@@ -0,0 +1,213 @@
+#include <fe/density.h>
+#include <fe/noise.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <string.h>
+
+static void* fe__density_alloc(size_t bytes) {
+    void* data = malloc(bytes);
+    if (!data) {
+        FE_FATAL("Could not allocate %lu bytes for density samples.", bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    return data;
+}
+
+static inline int64_t fe__density_floor_div(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+struct Density Density__create(float frequency, float threshold) {
+    return (struct Density){
+        .frequency = frequency,
+        .threshold = threshold,
+        .stride = FE_DENSITY_DEFAULT_STRIDE,
+        .backend = NOISE_BACKEND_PERLIN };
+}
+
+/**
+ * @brief FNV-1a of the `bytes` at `data` continued from `hash`.
+ */
+static uint32_t fe__density_fnv(uint32_t hash, const void* data,
+                                size_t bytes) {
+    const uint8_t* byte = data;
+    for (size_t i = 0; i < bytes; ++i)
+        hash = (hash ^ byte[i]) * 16777619u;
+    return hash;
+}
+
+uint32_t Density_hash(const struct Density* density, uint32_t seed) {
+    // field by field, since padding bytes are unspecified
+    uint32_t stride = density->stride ? density->stride : 1;
+    uint32_t backend = (uint32_t)density->backend;
+    uint8_t animated = density->animated;
+    float time = density->animated ? density->time : 0.0f;
+
+    uint32_t hash = fe__density_fnv(2166136261u, &seed, sizeof seed);
+    hash = fe__density_fnv(hash, &density->frequency,
+                           sizeof density->frequency);
+    hash = fe__density_fnv(hash, &density->threshold,
+                           sizeof density->threshold);
+    hash = fe__density_fnv(hash, &stride, sizeof stride);
+    hash = fe__density_fnv(hash, &backend, sizeof backend);
+    hash = fe__density_fnv(hash, &animated, sizeof animated);
+    return fe__density_fnv(hash, &time, sizeof time);
+}
+
+/**
+ * @brief Samples the noise of `density` over the lattice of `xs`, `ys`
+ * and `zs`, see `noise3_grid()`.
+ */
+static void fe__density_grid(const struct Density* density, float* out,
+                             struct Size3D size, const float* xs,
+                             const float* ys, const float* zs) {
+    switch (density->backend) {
+    case NOISE_BACKEND_SIMPLEX:
+        if (density->animated)
+            simplex4_grid(out, size, xs, ys, zs, density->time);
+        else
+            simplex3_grid(out, size, xs, ys, zs);
+        break;
+    case NOISE_BACKEND_PERLIN:
+    default:
+        if (density->animated)
+            noise4_grid(out, size, xs, ys, zs, density->time);
+        else
+            noise3_grid(out, size, xs, ys, zs);
+        break;
+    }
+}
+
+/**
+ * @brief Lattice along one axis for the `len` voxels from `origin`:
+ * returns the number of lattice points, sets `*first` to the coordinate
+ * of the first one, and fills `cell` and `frac` with the lattice cell of
+ * each voxel and its position within it.
+ */
+static size_t fe__density_axis(int64_t origin, size_t len, uint32_t stride,
+                               int64_t* first, uint32_t* cell, float* frac) {
+    *first = fe__density_floor_div(origin, stride) * stride;
+    for (size_t i = 0; i < len; ++i) {
+        int64_t offset = origin + (int64_t)i - *first;
+        cell[i] = (uint32_t)(offset / stride);
+        frac[i] = (float)(offset % stride) / (float)stride;
+    }
+    // the last voxel needs the point after its cell too
+    return cell[len - 1] + 2;
+}
+
+void Density_sample(const struct Density* density, struct ChunkCoord origin,
+                    struct Size3D size, float* out) {
+    if (size.x == 0 || size.y == 0 || size.z == 0)
+        return;
+
+    uint32_t stride = density->stride ? density->stride : 1;
+    if (stride == 1) {
+        float* coords = fe__density_alloc(
+            ((size_t)size.x + size.y + size.z) * sizeof *coords);
+        float* xs = coords;
+        float* ys = xs + size.x;
+        float* zs = ys + size.y;
+        for (size_t i = 0; i < size.x; ++i)
+            xs[i] = (float)(origin.x + (int64_t)i) * density->frequency;
+        for (size_t i = 0; i < size.y; ++i)
+            ys[i] = (float)(origin.y + (int64_t)i) * density->frequency;
+        for (size_t i = 0; i < size.z; ++i)
+            zs[i] = (float)(origin.z + (int64_t)i) * density->frequency;
+
+        fe__density_grid(density, out, size, xs, ys, zs);
+        free(coords);
+        return;
+    }
+
+    size_t voxel_axes = (size_t)size.x + size.y + size.z;
+    uint32_t* cells = fe__density_alloc(voxel_axes * sizeof *cells);
+    float* fracs = fe__density_alloc(voxel_axes * sizeof *fracs);
+    uint32_t* cx = cells;
+    uint32_t* cy = cx + size.x;
+    uint32_t* cz = cy + size.y;
+    float* fx = fracs;
+    float* fy = fx + size.x;
+    float* fz = fy + size.y;
+
+    int64_t first[3];
+    struct Size3D lattice = {
+        (uint32_t)fe__density_axis(origin.x, size.x, stride, &first[0], cx, fx),
+        (uint32_t)fe__density_axis(origin.y, size.y, stride, &first[1], cy, fy),
+        (uint32_t)fe__density_axis(origin.z, size.z, stride, &first[2], cz, fz) };
+
+    size_t lattice_axes = (size_t)lattice.x + lattice.y + lattice.z;
+    size_t lattice_len = (size_t)lattice.x * lattice.y * lattice.z;
+    float* coords = fe__density_alloc(lattice_axes * sizeof *coords);
+    float* samples = fe__density_alloc(lattice_len * sizeof *samples);
+    float* xs = coords;
+    float* ys = xs + lattice.x;
+    float* zs = ys + lattice.y;
+    for (size_t i = 0; i < lattice.x; ++i)
+        xs[i] = (float)(first[0] + (int64_t)i * stride) * density->frequency;
+    for (size_t i = 0; i < lattice.y; ++i)
+        ys[i] = (float)(first[1] + (int64_t)i * stride) * density->frequency;
+    for (size_t i = 0; i < lattice.z; ++i)
+        zs[i] = (float)(first[2] + (int64_t)i * stride) * density->frequency;
+    fe__density_grid(density, samples, lattice, xs, ys, zs);
+
+    size_t step_y = lattice.x;
+    size_t step_z = (size_t)lattice.x * lattice.y;
+    for (size_t z = 0; z < size.z; ++z) {
+        for (size_t y = 0; y < size.y; ++y) {
+            const float* row = samples + cy[y] * step_y + cz[z] * step_z;
+            float* dst = out + (y + z * size.y) * size.x;
+            for (size_t x = 0; x < size.x; ++x) {
+                const float* s = row + cx[x];
+                float c00 = s[0] + fx[x] * (s[1] - s[0]);
+                float c10 = s[step_y] + fx[x] * (s[step_y + 1] - s[step_y]);
+                float c01 = s[step_z] + fx[x] * (s[step_z + 1] - s[step_z]);
+                float c11 = s[step_y + step_z] + fx[x]
+                    * (s[step_y + step_z + 1] - s[step_y + step_z]);
+                float c0 = c00 + fy[y] * (c10 - c00);
+                float c1 = c01 + fy[y] * (c11 - c01);
+                dst[x] = c0 + fz[z] * (c1 - c0);
+            }
+        }
+    }
+
+    free(samples);
+    free(coords);
+    free(fracs);
+    free(cells);
+}
+
+void Density_fill(const struct Density* density, struct Chunk* chunk,
+                  struct ChunkCoord origin, DensityMaterialFn material,
+                  void* user) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `Density_fill`");
+        return;
+    }
+
+    struct Size3D size = chunk->size;
+    float* samples = fe__density_alloc(
+        (size_t)size.x * size.y * size.z * sizeof *samples);
+    Density_sample(density, origin, size, samples);
+
+    const float* sample = samples;
+    for (uint32_t z = 0; z < size.z; ++z) {
+        for (uint32_t y = 0; y < size.y; ++y) {
+            for (uint32_t x = 0; x < size.x; ++x, ++sample) {
+                if (*sample < density->threshold)
+                    continue;
+
+                struct ChunkCoord voxel = {
+                    origin.x + (int32_t)x,
+                    origin.y + (int32_t)y,
+                    origin.z + (int32_t)z };
+                uint16_t type = material
+                    ? material(voxel, *sample, user) : CHUNK_VOXEL_SOLID;
+                Chunk_set_type(chunk, (struct Size3D){ x, y, z }, type);
+            }
+        }
+    }
+
+    free(samples);
+}
@@ -0,0 +1,127 @@
+#include <fe/jobs.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <unistd.h>
+
+static void fe__job_queue_push(struct fe__job_queue_t* queue, struct Job job) {
+    if (queue->len == queue->cap) {
+        size_t cap = queue->cap ? queue->cap * 2 : 64;
+        struct Job* data = malloc(cap * sizeof *data);
+        if (!data) {
+            FE_FATAL("Could not allocate %lu bytes for job queue.",
+                     cap * sizeof *data);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+
+        // unwrap the ring so it starts at 0 again
+        for (size_t i = 0; i < queue->len; ++i)
+            data[i] = queue->data[(queue->head + i) % queue->cap];
+
+        free(queue->data);
+        queue->data = data;
+        queue->cap = cap;
+        queue->head = 0;
+    }
+
+    queue->data[(queue->head + queue->len) % queue->cap] = job;
+    ++queue->len;
+}
+
+static struct Job fe__job_queue_pop(struct fe__job_queue_t* queue) {
+    struct Job job = queue->data[queue->head];
+    queue->head = (queue->head + 1) % queue->cap;
+    --queue->len;
+    return job;
+}
+
+static void* fe__job_worker(void* arg) {
+    struct JobPool* pool = arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->queue.len == 0 && !pool->stopping)
+            pthread_cond_wait(&pool->has_work, &pool->lock);
+        if (pool->queue.len == 0)
+            break;
+
+        struct Job job = fe__job_queue_pop(&pool->queue);
+        ++pool->running;
+        pthread_mutex_unlock(&pool->lock);
+
+        job.run(job.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        --pool->running;
+        if (pool->queue.len == 0 && pool->running == 0)
+            pthread_cond_broadcast(&pool->idle);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+struct JobPool* JobPool__create(size_t thread_count) {
+    if (thread_count == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cores > 0 ? (size_t)cores : 1;
+    }
+
+    struct JobPool* pool = calloc(1, sizeof *pool);
+    pthread_t* threads = calloc(thread_count, sizeof *threads);
+    if (!pool || !threads) {
+        FE_FATAL("Could not allocate job pool of %lu threads.", thread_count);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->has_work, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pool->threads = threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        if (pthread_create(&pool->threads[i], NULL, fe__job_worker, pool)) {
+            FE_FATAL("Could not start job pool thread %lu.", i);
+            exit(FE_ERR_THREAD_INIT);
+        }
+        ++pool->thread_count;
+    }
+
+    return pool;
+}
+
+void JobPool_submit(struct JobPool* pool, void (*run)(void* arg), void* arg) {
+    pthread_mutex_lock(&pool->lock);
+    fe__job_queue_push(&pool->queue, (struct Job){ .run = run, .arg = arg });
+    pthread_cond_signal(&pool->has_work);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void JobPool_wait(struct JobPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->queue.len > 0 || pool->running > 0)
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void JobPool_destroy(struct JobPool* pool) {
+    if (!pool) {
+        FE_WARNING("Warning: NULL pool passed to `JobPool_destroy`");
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->has_work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->thread_count; ++i)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->has_work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->queue.data);
+    free(pool->threads);
+    free(pool);
+}
@@ -38,10 +38,12 @@ void fe_log(enum LogLevel level, FILE* out, const char* fmt, ...) {
             break;
     }
 
+    // may be called from job pool threads, so no shared `localtime()` 
     char localtime_buf[32];
     time_t now = time(NULL);
+    struct tm now_tm;
     size_t res = strftime(localtime_buf, sizeof localtime_buf, 
-                          "%Y-%m-%d %H:%M:%S ", localtime(&now));
+                          "%Y-%m-%d %H:%M:%S ", localtime_r(&now, &now_tm));
 
     if (res == 0) {
         // how do i log this lol 
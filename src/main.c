@@ -15,13 +15,16 @@
 #include <cglm/cglm.h>
 
 #include <fe/geometries/vchunk.h>
+#include <fe/world.h>
+#include <fe/stream.h>
+#include <fe/region.h>
+#include <fe/density.h>
+#include <fe/jobs.h>
 #include <fe/glfw_callbacks.h>
 #include <fe/glinfo.h>
 #include <fe/logger.h>
 #include <fe/err.h>
 
-#include <demo/noise1234.h>
-
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -61,6 +64,32 @@ int verify_working_directory();
 */
 void* get_resource(const char* path, void** data_p, size_t* size);
 
+// Version of generate_chunk(), hashed with the density field into the tag
+// of the regions the demo saves its terrain to. Bump it whenever the
+// terrain changes other than through the field (e.g. its materials), so
+// that terrain saved by earlier runs is regenerated rather than loaded.
+#define TERRAIN_GENERATOR 2
+
+struct terrain {
+    struct World* world;
+    struct RegionStore* regions; // chunks generated in earlier runs 
+    pthread_mutex_t regions_lock; // chunks are generated on the pool 
+    struct Density density;
+};
+
+/**
+ * @brief Bands the demo terrain by height, to tell materials apart.
+ */
+uint16_t terrain_material(struct ChunkCoord voxel, float density, void* user);
+
+/**
+ * @brief Loads the demo terrain chunk at `coord` from the regions of the 
+ * `struct terrain` passed as `terrain`, or generates and saves it, 
+ * sampling the noise in world voxel coordinates so that it is continuous 
+ * across chunks.
+ */
+struct Chunk generate_chunk(struct ChunkCoord coord, void* terrain);
+
 static mat4 projection;
 
 void glfw_framebuffer_size_callback(GLFWwindow* window, int x, int y) {
@@ -263,26 +292,39 @@ int main(int argc, const char** argv) {
     test.voxels[4].enabled = true;
     test.voxels[20].enabled = true;*/ 
 
-    struct Chunk test = Chunk__create((struct Size3D){ 16, 16, 16 });
-    for (size_t i = 0; i < 16 * 16 * 16; ++i) {
-        struct Size3D coord = Chunk_get_iaspos(&test, i);
-
-        //printf("%d %d %d\n", coord.x, coord.y, coord.z);
-
-        double noise = 0.0;
-
-        noise = noise3((float)coord.x / 10., 
-                       (float)coord.y / 10., 
-                       (float)coord.z / 10.);
-
-        //printf("%.2lf ", noise);
-        if (noise >= 0.16) test.voxels[i].enabled = true;
-    } //puts("");
+    // streaming churns through chunk buffers, back their pool with huge pages
+    Chunk_init_buffers(true);
+    struct World world = World__create((struct Size3D){ 16, 16, 16 });
+    struct Density density = Density__create(0.1f, 0.16f);
+    struct RegionStore regions = RegionStore__create(
+        "./world", world.chunk_size, Density_hash(&density, TERRAIN_GENERATOR));
+    struct terrain terrain = { 
+        .world = &world, .regions = &regions, .density = density };
+    pthread_mutex_init(&terrain.regions_lock, NULL);
 
     //struct Size3D p = Chunk_get_iaspos(&test, 30);
     //FE_DEBUG("idx 30 for chunk (4, 4, 2) is in pos %u %u %u\n", p.x, p.y, p.z);
 
-    struct ChunkMesh test_mesh = ChunkMesh__from_chunk(&test);
+    struct ChunkMeshOptions mesh_options = { 
+        .mesher = CHUNK_MESHER_GREEDY, 
+        .format = CHUNK_VERTEX_INSTANCED };
+
+    // chunks around the camera are generated and meshed on the pool as 
+    // it moves, and show up once their mesh has been polled 
+    struct JobPool* pool = JobPool__create(0);
+    struct ChunkStream stream = ChunkStream__create(&world, pool, 
+        (struct ChunkStreamOptions){
+            .load_radius = 6,
+            .unload_radius = 8,
+            .max_loads = 32,
+            .max_meshing = 32,
+            .max_generating = 64,
+            .compress_radius = 4,
+            .compress_idle = 600,
+            .max_compress = 16,
+            .mesh_options = mesh_options,
+            .generate = generate_chunk,
+            .user = &terrain });
 
     // initialize camera position matrix 
     
@@ -298,8 +340,13 @@ int main(int argc, const char** argv) {
     GLuint u_resolution = glGetUniformLocation(program, "u_resolution");
     GLuint u_time = glGetUniformLocation(program, "u_time");
     GLuint u_lightpos = glGetUniformLocation(program, "u_lightpos");
+    GLuint u_format = glGetUniformLocation(program, "u_format");
+    GLuint u_scale = glGetUniformLocation(program, "u_scale");
+    GLuint u_chunk_origin = glGetUniformLocation(program, "u_chunk_origin");
     glUniform2f(u_resolution, 400.0f, 400.0f);
     glUniform1f(u_time, 0.0f);
+    glUniform1i(u_format, mesh_options.format);
+    glUniform1f(u_scale, 1.0f);
     glUseProgram(0);
 
     glEnable(GL_DEPTH_TEST);
@@ -307,11 +354,7 @@ int main(int argc, const char** argv) {
     glCullFace(GL_BACK);
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-    int enabled = 0;
-    size_t size = test.size.x * test.size.y * test.size.z;
-    for (size_t i = 0; i < size; ++i) {
-        enabled += test.voxels[i].enabled ? 1 : 0;
-    }
+    FE_INFO("Streaming %lu chunks around the camera.", stream.offset_count);
 
     float yaw_mult = 60.0f;
     float pitch_mult = 60.0f;
@@ -382,8 +425,18 @@ int main(int argc, const char** argv) {
         //glUniform2f(u_resolution, 400.0f, 400.0f);
         //glUniform1f(u_time, glfwGetTime());
 
-        glBindVertexArray(test_mesh.vao);
-        glDrawArrays(GL_TRIANGLES, 0, ChunkMesh_polygon_count(&test_mesh));
+        ChunkStream_update(&stream, camera_pos, direction);
+
+        size_t cursor = 0;
+        for (struct WorldChunk* entry; (entry = World_next(&world, &cursor));) {
+            if (!entry->meshed)
+                continue;
+
+            struct ChunkCoord origin = World_chunk_origin(&world, entry->coord);
+            glUniform3f(u_chunk_origin, (float)origin.x, (float)origin.y, 
+                        (float)origin.z);
+            ChunkMesh_draw(&entry->mesh);
+        }
         //glBindVertexArray(vao);
         //glDrawArrays(GL_TRIANGLES, 0, 3);
         
@@ -402,8 +455,27 @@ int main(int argc, const char** argv) {
     }
 
     //Chunk_destroy(&base_chunk);
-    Chunk_destroy(&test);
-    free(test_mesh.verts.data);
+    ChunkStream_destroy(&stream);
+    JobPool_destroy(pool);
+
+    struct PoolStats buffers = BufferPool_stats(Chunk_buffer_pool(), NULL);
+    FE_INFO("Chunk buffers: %lu KiB used of %lu KiB in %lu slabs "
+            "(%lu huge), %lu allocations.", buffers.used_bytes >> 10, 
+            buffers.reserved_bytes >> 10, buffers.slabs, buffers.huge_slabs, 
+            buffers.allocs);
+
+    size_t voxel_bytes = 0;
+    size_t compressed = 0;
+    size_t cursor = 0;
+    for (struct WorldChunk* entry; (entry = World_next(&world, &cursor));) {
+        voxel_bytes += Chunk_storage_bytes(&entry->chunk);
+        compressed += entry->chunk.compressed;
+    }
+    FE_INFO("%lu KiB of voxels in %lu chunks, %lu of them compressed.", 
+            voxel_bytes >> 10, World_count(&world), compressed);
+    World_destroy(&world);
+    RegionStore_destroy(&regions);
+    pthread_mutex_destroy(&terrain.regions_lock);
     glfwTerminate();
 }
 
@@ -449,3 +521,30 @@ void* get_resource(const char* path, void** data_p, size_t* size) {
     return data;
 }
 
+uint16_t terrain_material(struct ChunkCoord voxel, float density, void* user) {
+    (void)density;
+    (void)user;
+    return 1 + (uint16_t)((uint32_t)voxel.y / 6 % 16);
+}
+
+struct Chunk generate_chunk(struct ChunkCoord coord, void* terrain_p) {
+    struct terrain* terrain = terrain_p;
+    struct Chunk chunk;
+    pthread_mutex_lock(&terrain->regions_lock);
+    bool loaded = RegionStore_load(terrain->regions, coord, &chunk);
+    pthread_mutex_unlock(&terrain->regions_lock);
+    if (loaded)
+        return chunk;
+
+    struct ChunkCoord origin = World_chunk_origin(terrain->world, coord);
+    chunk = Chunk16__create_palette();
+    Chunk_set_layout(&chunk, CHUNK_LAYOUT_MORTON);
+    Density_fill(&terrain->density, &chunk, origin, terrain_material, NULL);
+
+    // empty chunks are left without storage and mesh to nothing 
+    Chunk_collapse(&chunk);
+    pthread_mutex_lock(&terrain->regions_lock);
+    RegionStore_save(terrain->regions, coord, &chunk);
+    pthread_mutex_unlock(&terrain->regions_lock);
+    return chunk;
+}
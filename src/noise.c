@@ -0,0 +1,383 @@
+#include <fe/noise.h>
+#include <demo/noise1234.h>
+
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FE_NOISE_X86
+#include <immintrin.h>
+#endif
+
+// the permutation table of noise1234.c, which its header does not export
+extern unsigned char perm[];
+
+// `perm` widened for gathers
+static int32_t fe__noise_perm[512];
+
+static pthread_once_t fe__noise_once = PTHREAD_ONCE_INIT;
+static enum NoiseIsa fe__noise_supported = NOISE_ISA_SCALAR;
+static enum NoiseIsa fe__noise_active = NOISE_ISA_SCALAR;
+
+static void fe__noise_init(void) {
+    for (size_t i = 0; i < 512; ++i)
+        fe__noise_perm[i] = perm[i];
+
+#ifdef FE_NOISE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        fe__noise_supported = NOISE_ISA_AVX2;
+    else if (__builtin_cpu_supports("sse4.1"))
+        fe__noise_supported = NOISE_ISA_SSE41;
+#endif
+    fe__noise_active = fe__noise_supported;
+}
+
+enum NoiseIsa noise_isa(void) {
+    pthread_once(&fe__noise_once, fe__noise_init);
+    return fe__noise_active;
+}
+
+enum NoiseIsa noise_force_isa(enum NoiseIsa isa) {
+    pthread_once(&fe__noise_once, fe__noise_init);
+    fe__noise_active = isa < fe__noise_supported ? isa : fe__noise_supported;
+    return fe__noise_active;
+}
+
+#ifdef FE_NOISE_X86
+
+/*
+ * The kernels below follow noise3() of noise1234.c operation for
+ * operation: FASTFLOOR (which floors integers to the integer below), the
+ * fade polynomial evaluated left to right, LERP as a + t * (b - a) and
+ * grad3 with its sign flips done on the sign bit. FMA is deliberately
+ * not enabled, so that no multiply-add is fused differently from the
+ * scalar code.
+ */
+
+#define FE_NOISE_AVX2 __attribute__((target("avx2")))
+#define FE_NOISE_SSE41 __attribute__((target("sse4.1")))
+
+FE_NOISE_AVX2
+static inline __m256i fe__noise_floor_avx2(__m256 x) {
+    __m256i i = _mm256_cvttps_epi32(x);
+    __m256i below = _mm256_castps_si256(
+        _mm256_cmp_ps(_mm256_cvtepi32_ps(i), x, _CMP_LT_OQ));
+    // i - 1, plus 1 where (float)i < x
+    return _mm256_sub_epi32(_mm256_sub_epi32(i, _mm256_set1_epi32(1)), below);
+}
+
+FE_NOISE_AVX2
+static inline __m256 fe__noise_fade_avx2(__m256 t) {
+    __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)),
+                                 _mm256_set1_ps(15.0f));
+    inner = _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(t3, inner);
+}
+
+FE_NOISE_AVX2
+static inline __m256 fe__noise_lerp_avx2(__m256 t, __m256 a, __m256 b) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+FE_NOISE_AVX2
+static inline __m256i fe__noise_perm_avx2(__m256i idx) {
+    return _mm256_i32gather_epi32((const int*)fe__noise_perm, idx, 4);
+}
+
+FE_NOISE_AVX2
+static inline __m256 fe__noise_grad3_avx2(__m256i hash, __m256 x, __m256 y,
+                                          __m256 z) {
+    __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    __m256 below8 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+    __m256 below4 = _mm256_castsi256_ps(
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 x_for_v = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+        _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+
+    __m256 u = _mm256_blendv_ps(y, x, below8);
+    __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, x_for_v), y, below4);
+
+    __m256 u_sign = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+    __m256 v_sign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(u, u_sign), _mm256_xor_ps(v, v_sign));
+}
+
+FE_NOISE_AVX2
+static __m256 fe__noise3_avx2(__m256 x, __m256 y, __m256 z) {
+    __m256i mask = _mm256_set1_epi32(0xff);
+    __m256i one = _mm256_set1_epi32(1);
+    __m256 fone = _mm256_set1_ps(1.0f);
+
+    __m256i ix0 = fe__noise_floor_avx2(x);
+    __m256i iy0 = fe__noise_floor_avx2(y);
+    __m256i iz0 = fe__noise_floor_avx2(z);
+    __m256 fx0 = _mm256_sub_ps(x, _mm256_cvtepi32_ps(ix0));
+    __m256 fy0 = _mm256_sub_ps(y, _mm256_cvtepi32_ps(iy0));
+    __m256 fz0 = _mm256_sub_ps(z, _mm256_cvtepi32_ps(iz0));
+    __m256 fx1 = _mm256_sub_ps(fx0, fone);
+    __m256 fy1 = _mm256_sub_ps(fy0, fone);
+    __m256 fz1 = _mm256_sub_ps(fz0, fone);
+    __m256i ix1 = _mm256_and_si256(_mm256_add_epi32(ix0, one), mask);
+    __m256i iy1 = _mm256_and_si256(_mm256_add_epi32(iy0, one), mask);
+    __m256i iz1 = _mm256_and_si256(_mm256_add_epi32(iz0, one), mask);
+    ix0 = _mm256_and_si256(ix0, mask);
+    iy0 = _mm256_and_si256(iy0, mask);
+    iz0 = _mm256_and_si256(iz0, mask);
+
+    __m256 r = fe__noise_fade_avx2(fz0);
+    __m256 t = fe__noise_fade_avx2(fy0);
+    __m256 s = fe__noise_fade_avx2(fx0);
+
+    __m256i pz0 = fe__noise_perm_avx2(iz0);
+    __m256i pz1 = fe__noise_perm_avx2(iz1);
+    __m256i p00 = fe__noise_perm_avx2(_mm256_add_epi32(iy0, pz0));
+    __m256i p01 = fe__noise_perm_avx2(_mm256_add_epi32(iy0, pz1));
+    __m256i p10 = fe__noise_perm_avx2(_mm256_add_epi32(iy1, pz0));
+    __m256i p11 = fe__noise_perm_avx2(_mm256_add_epi32(iy1, pz1));
+
+    __m256 nxy0, nxy1, nx0, nx1, n0, n1;
+    nxy0 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix0, p00)), fx0, fy0, fz0);
+    nxy1 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix0, p01)), fx0, fy0, fz1);
+    nx0 = fe__noise_lerp_avx2(r, nxy0, nxy1);
+
+    nxy0 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix0, p10)), fx0, fy1, fz0);
+    nxy1 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix0, p11)), fx0, fy1, fz1);
+    nx1 = fe__noise_lerp_avx2(r, nxy0, nxy1);
+
+    n0 = fe__noise_lerp_avx2(t, nx0, nx1);
+
+    nxy0 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix1, p00)), fx1, fy0, fz0);
+    nxy1 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix1, p01)), fx1, fy0, fz1);
+    nx0 = fe__noise_lerp_avx2(r, nxy0, nxy1);
+
+    nxy0 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix1, p10)), fx1, fy1, fz0);
+    nxy1 = fe__noise_grad3_avx2(
+        fe__noise_perm_avx2(_mm256_add_epi32(ix1, p11)), fx1, fy1, fz1);
+    nx1 = fe__noise_lerp_avx2(r, nxy0, nxy1);
+
+    n1 = fe__noise_lerp_avx2(t, nx0, nx1);
+
+    return _mm256_mul_ps(_mm256_set1_ps(0.936f),
+                         fe__noise_lerp_avx2(s, n0, n1));
+}
+
+FE_NOISE_AVX2
+static size_t fe__noise3_batch_avx2(const float* x, const float* y,
+                                    const float* z, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, fe__noise3_avx2(_mm256_loadu_ps(x + i),
+                                                  _mm256_loadu_ps(y + i),
+                                                  _mm256_loadu_ps(z + i)));
+    return i;
+}
+
+FE_NOISE_AVX2
+static size_t fe__noise3_row_avx2(float* out, const float* xs, size_t n,
+                                  float y, float z) {
+    __m256 vy = _mm256_set1_ps(y);
+    __m256 vz = _mm256_set1_ps(z);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i,
+                         fe__noise3_avx2(_mm256_loadu_ps(xs + i), vy, vz));
+    return i;
+}
+
+FE_NOISE_SSE41
+static inline __m128i fe__noise_floor_sse41(__m128 x) {
+    __m128i i = _mm_cvttps_epi32(x);
+    __m128i below = _mm_castps_si128(_mm_cmplt_ps(_mm_cvtepi32_ps(i), x));
+    return _mm_sub_epi32(_mm_sub_epi32(i, _mm_set1_epi32(1)), below);
+}
+
+FE_NOISE_SSE41
+static inline __m128 fe__noise_fade_sse41(__m128 t) {
+    __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)),
+                              _mm_set1_ps(15.0f));
+    inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(t3, inner);
+}
+
+FE_NOISE_SSE41
+static inline __m128 fe__noise_lerp_sse41(__m128 t, __m128 a, __m128 b) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+// no gathers before AVX2, lanes are looked up one by one
+FE_NOISE_SSE41
+static inline __m128i fe__noise_perm_sse41(__m128i idx) {
+    return _mm_setr_epi32(fe__noise_perm[_mm_extract_epi32(idx, 0)],
+                          fe__noise_perm[_mm_extract_epi32(idx, 1)],
+                          fe__noise_perm[_mm_extract_epi32(idx, 2)],
+                          fe__noise_perm[_mm_extract_epi32(idx, 3)]);
+}
+
+FE_NOISE_SSE41
+static inline __m128 fe__noise_grad3_sse41(__m128i hash, __m128 x, __m128 y,
+                                           __m128 z) {
+    __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+    __m128 below8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+    __m128 below4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 x_for_v = _mm_castsi128_ps(_mm_or_si128(
+        _mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+        _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+
+    __m128 u = _mm_blendv_ps(y, x, below8);
+    __m128 v = _mm_blendv_ps(_mm_blendv_ps(z, x, x_for_v), y, below4);
+
+    __m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+    __m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(v, v_sign));
+}
+
+FE_NOISE_SSE41
+static __m128 fe__noise3_sse41(__m128 x, __m128 y, __m128 z) {
+    __m128i mask = _mm_set1_epi32(0xff);
+    __m128i one = _mm_set1_epi32(1);
+    __m128 fone = _mm_set1_ps(1.0f);
+
+    __m128i ix0 = fe__noise_floor_sse41(x);
+    __m128i iy0 = fe__noise_floor_sse41(y);
+    __m128i iz0 = fe__noise_floor_sse41(z);
+    __m128 fx0 = _mm_sub_ps(x, _mm_cvtepi32_ps(ix0));
+    __m128 fy0 = _mm_sub_ps(y, _mm_cvtepi32_ps(iy0));
+    __m128 fz0 = _mm_sub_ps(z, _mm_cvtepi32_ps(iz0));
+    __m128 fx1 = _mm_sub_ps(fx0, fone);
+    __m128 fy1 = _mm_sub_ps(fy0, fone);
+    __m128 fz1 = _mm_sub_ps(fz0, fone);
+    __m128i ix1 = _mm_and_si128(_mm_add_epi32(ix0, one), mask);
+    __m128i iy1 = _mm_and_si128(_mm_add_epi32(iy0, one), mask);
+    __m128i iz1 = _mm_and_si128(_mm_add_epi32(iz0, one), mask);
+    ix0 = _mm_and_si128(ix0, mask);
+    iy0 = _mm_and_si128(iy0, mask);
+    iz0 = _mm_and_si128(iz0, mask);
+
+    __m128 r = fe__noise_fade_sse41(fz0);
+    __m128 t = fe__noise_fade_sse41(fy0);
+    __m128 s = fe__noise_fade_sse41(fx0);
+
+    __m128i pz0 = fe__noise_perm_sse41(iz0);
+    __m128i pz1 = fe__noise_perm_sse41(iz1);
+    __m128i p00 = fe__noise_perm_sse41(_mm_add_epi32(iy0, pz0));
+    __m128i p01 = fe__noise_perm_sse41(_mm_add_epi32(iy0, pz1));
+    __m128i p10 = fe__noise_perm_sse41(_mm_add_epi32(iy1, pz0));
+    __m128i p11 = fe__noise_perm_sse41(_mm_add_epi32(iy1, pz1));
+
+    __m128 nxy0, nxy1, nx0, nx1, n0, n1;
+    nxy0 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix0, p00)), fx0, fy0, fz0);
+    nxy1 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix0, p01)), fx0, fy0, fz1);
+    nx0 = fe__noise_lerp_sse41(r, nxy0, nxy1);
+
+    nxy0 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix0, p10)), fx0, fy1, fz0);
+    nxy1 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix0, p11)), fx0, fy1, fz1);
+    nx1 = fe__noise_lerp_sse41(r, nxy0, nxy1);
+
+    n0 = fe__noise_lerp_sse41(t, nx0, nx1);
+
+    nxy0 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix1, p00)), fx1, fy0, fz0);
+    nxy1 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix1, p01)), fx1, fy0, fz1);
+    nx0 = fe__noise_lerp_sse41(r, nxy0, nxy1);
+
+    nxy0 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix1, p10)), fx1, fy1, fz0);
+    nxy1 = fe__noise_grad3_sse41(
+        fe__noise_perm_sse41(_mm_add_epi32(ix1, p11)), fx1, fy1, fz1);
+    nx1 = fe__noise_lerp_sse41(r, nxy0, nxy1);
+
+    n1 = fe__noise_lerp_sse41(t, nx0, nx1);
+
+    return _mm_mul_ps(_mm_set1_ps(0.936f), fe__noise_lerp_sse41(s, n0, n1));
+}
+
+FE_NOISE_SSE41
+static size_t fe__noise3_batch_sse41(const float* x, const float* y,
+                                     const float* z, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, fe__noise3_sse41(_mm_loadu_ps(x + i),
+                                                _mm_loadu_ps(y + i),
+                                                _mm_loadu_ps(z + i)));
+    return i;
+}
+
+FE_NOISE_SSE41
+static size_t fe__noise3_row_sse41(float* out, const float* xs, size_t n,
+                                   float y, float z) {
+    __m128 vy = _mm_set1_ps(y);
+    __m128 vz = _mm_set1_ps(z);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, fe__noise3_sse41(_mm_loadu_ps(xs + i), vy, vz));
+    return i;
+}
+
+#endif
+
+void noise3_batch(const float* x, const float* y, const float* z, float* out,
+                  size_t n) {
+    size_t done = 0;
+#ifdef FE_NOISE_X86
+    switch (noise_isa()) {
+    case NOISE_ISA_AVX2:
+        done = fe__noise3_batch_avx2(x, y, z, out, n);
+        break;
+    case NOISE_ISA_SSE41:
+        done = fe__noise3_batch_sse41(x, y, z, out, n);
+        break;
+    default:
+        break;
+    }
+#endif
+
+    for (size_t i = done; i < n; ++i)
+        out[i] = noise3(x[i], y[i], z[i]);
+}
+
+void noise3_grid(float* out, struct Size3D size, const float* xs,
+                 const float* ys, const float* zs) {
+    enum NoiseIsa isa = noise_isa();
+    (void)isa;
+
+    for (size_t k = 0; k < size.z; ++k) {
+        for (size_t j = 0; j < size.y; ++j) {
+            float* row = out + (j + k * size.y) * size.x;
+            size_t done = 0;
+#ifdef FE_NOISE_X86
+            if (isa == NOISE_ISA_AVX2)
+                done = fe__noise3_row_avx2(row, xs, size.x, ys[j], zs[k]);
+            else if (isa == NOISE_ISA_SSE41)
+                done = fe__noise3_row_sse41(row, xs, size.x, ys[j], zs[k]);
+#endif
+            for (size_t i = done; i < size.x; ++i)
+                row[i] = noise3(xs[i], ys[j], zs[k]);
+        }
+    }
+}
+
+void noise4_grid(float* out, struct Size3D size, const float* xs,
+                 const float* ys, const float* zs, float w) {
+    for (size_t k = 0; k < size.z; ++k)
+        for (size_t j = 0; j < size.y; ++j)
+            for (size_t i = 0; i < size.x; ++i)
+                *out++ = noise4(xs[i], ys[j], zs[k], w);
+}
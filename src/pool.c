@@ -0,0 +1,339 @@
+#include <fe/pool.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <sys/mman.h>
+#include <string.h>
+
+/**
+ * @brief Maps `bytes` bytes of zeroed memory for a slab. With `hugepages`,
+ * explicit huge pages are tried first, then transparent huge pages are
+ * requested for a regular mapping. `*huge` is set if either worked.
+ */
+static void* fe__slab_map(size_t bytes, bool hugepages, bool* huge) {
+    void* base = MAP_FAILED;
+    *huge = false;
+
+#ifdef MAP_HUGETLB
+    if (hugepages) {
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (base != MAP_FAILED) {
+        *huge = true;
+        return base;
+    }
+#endif
+
+    base = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+
+#ifdef MADV_HUGEPAGE
+    if (hugepages && madvise(base, bytes, MADV_HUGEPAGE) == 0)
+        *huge = true;
+#endif
+
+    return base;
+}
+
+static void fe__slab_pool_init(struct SlabPool* pool, size_t block_size,
+                               bool hugepages) {
+    // blocks hold the free list link while they are free
+    if (block_size < sizeof (void*))
+        block_size = sizeof (void*);
+    block_size = (block_size + sizeof (void*) - 1) & ~(sizeof (void*) - 1);
+
+    size_t slab_bytes = block_size * 2 > FE_POOL_SLAB_BYTES
+        ? block_size * 2 : FE_POOL_SLAB_BYTES;
+    slab_bytes = (slab_bytes + FE_POOL_SLAB_BYTES - 1)
+        & ~(FE_POOL_SLAB_BYTES - 1);
+
+    *pool = (struct SlabPool){
+        .block_size = block_size,
+        .slab_bytes = slab_bytes,
+        .hugepages = hugepages };
+    pthread_mutex_init(&pool->lock, NULL);
+}
+
+static void fe__slab_pool_fini(struct SlabPool* pool) {
+    for (size_t i = 0; i < pool->stats.slabs; ++i)
+        munmap(pool->slabs[i].base, pool->slabs[i].bytes);
+    free(pool->slabs);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+/**
+ * @brief Maps a new slab and makes it the one blocks are bumped from.
+ * Must be called with the lock of `pool` held.
+ */
+static void fe__slab_pool_grow(struct SlabPool* pool) {
+    if (pool->stats.slabs == pool->slab_cap) {
+        size_t cap = pool->slab_cap ? pool->slab_cap * 2 : 8;
+        struct fe__slab_t* slabs = realloc(pool->slabs, cap * sizeof *slabs);
+        if (!slabs) {
+            FE_FATAL("Could not allocate %lu bytes for slab list.",
+                     cap * sizeof *slabs);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+        pool->slabs = slabs;
+        pool->slab_cap = cap;
+    }
+
+    bool huge;
+    void* base = fe__slab_map(pool->slab_bytes, pool->hugepages, &huge);
+    if (!base) {
+        FE_FATAL("Could not map a %lu byte slab.", pool->slab_bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    pool->slabs[pool->stats.slabs++] = (struct fe__slab_t){
+        .base = base, .bytes = pool->slab_bytes };
+    pool->stats.huge_slabs += huge;
+    pool->stats.reserved_bytes += pool->slab_bytes;
+
+    // the tail of a slab too short for a block is never handed out
+    pool->bump = base;
+    pool->bump_end = (char*)base
+        + pool->slab_bytes / pool->block_size * pool->block_size;
+}
+
+static void* fe__slab_pool_alloc(struct SlabPool* pool, size_t requested) {
+    pthread_mutex_lock(&pool->lock);
+
+    void* block = pool->free_list;
+    if (block) {
+        pool->free_list = *(void**)block;
+    } else {
+        if (pool->bump == pool->bump_end)
+            fe__slab_pool_grow(pool);
+        block = pool->bump;
+        pool->bump += pool->block_size;
+    }
+
+    ++pool->stats.used_blocks;
+    ++pool->stats.allocs;
+    pool->stats.used_bytes += pool->block_size;
+    pool->stats.requested_bytes += requested;
+
+    pthread_mutex_unlock(&pool->lock);
+    return block;
+}
+
+static void fe__slab_pool_free(struct SlabPool* pool, void* block,
+                               size_t requested) {
+    pthread_mutex_lock(&pool->lock);
+
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+
+    --pool->stats.used_blocks;
+    ++pool->stats.frees;
+    pool->stats.used_bytes -= pool->block_size;
+    pool->stats.requested_bytes -= requested;
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static struct PoolStats fe__slab_pool_stats(struct SlabPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    struct PoolStats stats = pool->stats;
+    pthread_mutex_unlock(&pool->lock);
+    return stats;
+}
+
+struct SlabPool* SlabPool__create(size_t block_size, bool hugepages) {
+    struct SlabPool* pool = malloc(sizeof *pool);
+    if (!pool) {
+        FE_FATAL("Could not allocate %lu bytes for slab pool.", sizeof *pool);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    fe__slab_pool_init(pool, block_size, hugepages);
+    return pool;
+}
+
+void* SlabPool_alloc(struct SlabPool* pool) {
+    return fe__slab_pool_alloc(pool, pool->block_size);
+}
+
+void SlabPool_free(struct SlabPool* pool, void* block) {
+    if (block)
+        fe__slab_pool_free(pool, block, pool->block_size);
+}
+
+struct PoolStats SlabPool_stats(struct SlabPool* pool) {
+    return fe__slab_pool_stats(pool);
+}
+
+void SlabPool_destroy(struct SlabPool* pool) {
+    if (!pool) {
+        FE_WARNING("Warning: NULL pool passed to `SlabPool_destroy`");
+        return;
+    }
+
+    fe__slab_pool_fini(pool);
+    free(pool);
+}
+
+static inline size_t fe__pool_class_size(size_t class) {
+    if (class % 2 == 0)
+        return (size_t)1 << (FE_POOL_MIN_CLASS_LOG2 + class / 2);
+    return (size_t)3 << (FE_POOL_MIN_CLASS_LOG2 - 1 + class / 2);
+}
+
+/**
+ * @brief Returns the smallest class fitting `bytes`, or
+ * `FE_POOL_CLASS_COUNT` if it does not fit any.
+ */
+static inline size_t fe__pool_class_of(size_t bytes) {
+    if (bytes <= (size_t)1 << FE_POOL_MIN_CLASS_LOG2)
+        return 0;
+    if (bytes > (size_t)1 << FE_POOL_MAX_CLASS_LOG2)
+        return FE_POOL_CLASS_COUNT;
+
+    // bytes is in (2^k, 2^(k + 1)], and is either in the 1.5 * 2^k class
+    // or the 2^(k + 1) one depending on bit k - 1 of bytes - 1
+    size_t b = bytes - 1;
+    size_t k = 63 - (size_t)__builtin_clzll(b);
+    size_t upper = (b >> (k - 1)) & 1;
+    return 2 * (k - FE_POOL_MIN_CLASS_LOG2) + 1 + upper;
+}
+
+struct BufferPool* BufferPool__create(bool hugepages) {
+    struct BufferPool* pool = calloc(1, sizeof *pool);
+    if (!pool) {
+        FE_FATAL("Could not allocate %lu bytes for buffer pool.",
+                 sizeof *pool);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    for (size_t i = 0; i < FE_POOL_CLASS_COUNT; ++i)
+        fe__slab_pool_init(&pool->classes[i], fe__pool_class_size(i),
+                           hugepages);
+    pthread_mutex_init(&pool->large_lock, NULL);
+
+    return pool;
+}
+
+size_t BufferPool_usable(size_t bytes) {
+    if (bytes == 0)
+        return 0;
+
+    size_t class = fe__pool_class_of(bytes);
+    return class < FE_POOL_CLASS_COUNT ? fe__pool_class_size(class) : bytes;
+}
+
+void* BufferPool_alloc(struct BufferPool* pool, size_t bytes) {
+    if (bytes == 0)
+        return NULL;
+
+    size_t class = fe__pool_class_of(bytes);
+    if (class < FE_POOL_CLASS_COUNT)
+        return fe__slab_pool_alloc(&pool->classes[class], bytes);
+
+    void* data = malloc(bytes);
+    if (!data) {
+        FE_FATAL("Could not allocate %lu bytes for buffer.", bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    pthread_mutex_lock(&pool->large_lock);
+    ++pool->large.used_blocks;
+    ++pool->large.allocs;
+    pool->large.reserved_bytes += bytes;
+    pool->large.used_bytes += bytes;
+    pool->large.requested_bytes += bytes;
+    pthread_mutex_unlock(&pool->large_lock);
+
+    return data;
+}
+
+void* BufferPool_calloc(struct BufferPool* pool, size_t bytes) {
+    void* data = BufferPool_alloc(pool, bytes);
+    if (data)
+        memset(data, 0, bytes);
+    return data;
+}
+
+void BufferPool_free(struct BufferPool* pool, void* data, size_t bytes) {
+    if (!data)
+        return;
+
+    size_t class = fe__pool_class_of(bytes);
+    if (class < FE_POOL_CLASS_COUNT) {
+        fe__slab_pool_free(&pool->classes[class], data, bytes);
+        return;
+    }
+
+    free(data);
+
+    pthread_mutex_lock(&pool->large_lock);
+    --pool->large.used_blocks;
+    ++pool->large.frees;
+    pool->large.reserved_bytes -= bytes;
+    pool->large.used_bytes -= bytes;
+    pool->large.requested_bytes -= bytes;
+    pthread_mutex_unlock(&pool->large_lock);
+}
+
+void* BufferPool_realloc(struct BufferPool* pool, void* data, size_t bytes,
+                         size_t new_bytes) {
+    if (!data)
+        return BufferPool_alloc(pool, new_bytes);
+    if (new_bytes == 0) {
+        BufferPool_free(pool, data, bytes);
+        return NULL;
+    }
+
+    size_t class = fe__pool_class_of(bytes);
+    if (class < FE_POOL_CLASS_COUNT && class == fe__pool_class_of(new_bytes)) {
+        struct SlabPool* slabs = &pool->classes[class];
+        pthread_mutex_lock(&slabs->lock);
+        slabs->stats.requested_bytes += new_bytes - bytes;
+        pthread_mutex_unlock(&slabs->lock);
+        return data;
+    }
+
+    void* moved = BufferPool_alloc(pool, new_bytes);
+    memcpy(moved, data, bytes < new_bytes ? bytes : new_bytes);
+    BufferPool_free(pool, data, bytes);
+    return moved;
+}
+
+struct PoolStats BufferPool_stats(struct BufferPool* pool,
+                                  struct PoolStats classes[FE_POOL_CLASS_COUNT]) {
+    pthread_mutex_lock(&pool->large_lock);
+    struct PoolStats total = pool->large;
+    pthread_mutex_unlock(&pool->large_lock);
+
+    for (size_t i = 0; i < FE_POOL_CLASS_COUNT; ++i) {
+        struct PoolStats stats = fe__slab_pool_stats(&pool->classes[i]);
+        if (classes)
+            classes[i] = stats;
+
+        total.slabs += stats.slabs;
+        total.huge_slabs += stats.huge_slabs;
+        total.reserved_bytes += stats.reserved_bytes;
+        total.used_bytes += stats.used_bytes;
+        total.requested_bytes += stats.requested_bytes;
+        total.used_blocks += stats.used_blocks;
+        total.allocs += stats.allocs;
+        total.frees += stats.frees;
+    }
+
+    return total;
+}
+
+void BufferPool_destroy(struct BufferPool* pool) {
+    if (!pool) {
+        FE_WARNING("Warning: NULL pool passed to `BufferPool_destroy`");
+        return;
+    }
+
+    for (size_t i = 0; i < FE_POOL_CLASS_COUNT; ++i)
+        fe__slab_pool_fini(&pool->classes[i]);
+    pthread_mutex_destroy(&pool->large_lock);
+    free(pool);
+}
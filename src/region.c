@@ -0,0 +1,591 @@
+#include <fe/region.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Head of a chunk payload, followed by `runs` runs of voxels in storage
+ * order, each a 16-bit voxel type and a LEB128 length.
+ */
+struct fe__region_payload_t {
+    uint8_t storage;
+    uint8_t layout;
+    uint16_t reserved;
+    uint32_t runs;
+    double scale;
+};
+
+struct fe__region_buf_t {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+};
+
+static inline struct fe__region_header_t* fe__region_header(
+        const struct Region* region) {
+    return (struct fe__region_header_t*)region->map;
+}
+
+static char* fe__region_strdup(const char* str) {
+    size_t bytes = strlen(str) + 1;
+    char* copy = malloc(bytes);
+    if (!copy) {
+        FE_FATAL("Could not allocate %lu bytes for region path.", bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    return memcpy(copy, str, bytes);
+}
+
+static inline int32_t fe__region_div(int32_t a, int32_t b) {
+    return a / b - (a % b < 0);
+}
+
+static inline int32_t fe__region_mod(int32_t a, int32_t b) {
+    int32_t m = a % b;
+    return m < 0 ? m + b : m;
+}
+
+/**
+ * @brief Writes all of `data` at `offset` of `fd`.
+ */
+static bool fe__region_write(int fd, const void* data, size_t bytes,
+                             size_t offset) {
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, data, bytes, (off_t)offset);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+
+        data = (const uint8_t*)data + written;
+        bytes -= (size_t)written;
+        offset += (size_t)written;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps the whole file of `region`, replacing the previous mapping.
+ * Entries are updated through the mapping, so it is shared and writable.
+ */
+static bool fe__region_remap(struct Region* region) {
+    if (region->map)
+        munmap(region->map, region->map_bytes);
+
+    region->map = mmap(NULL, region->file_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, region->fd, 0);
+    if (region->map == MAP_FAILED) {
+        FE_ERROR("Could not map region file %s: %s", region->path,
+                 strerror(errno));
+        region->map = NULL;
+        region->map_bytes = 0;
+        return false;
+    }
+
+    region->map_bytes = region->file_bytes;
+    return true;
+}
+
+static void fe__region_free(struct Region* region) {
+    if (region->map)
+        munmap(region->map, region->map_bytes);
+    close(region->fd);
+    free(region->path);
+    free(region);
+}
+
+/**
+ * @brief Empties the file of `region` down to a fresh header.
+ */
+static bool fe__region_reset(struct Region* region) {
+    region->file_bytes = sizeof (struct fe__region_header_t);
+    // truncating to 0 first drops the old table and payloads, leaving the
+    // new table sparse until chunks are saved
+    if (ftruncate(region->fd, 0) != 0
+        || ftruncate(region->fd, (off_t)region->file_bytes) != 0) {
+        FE_ERROR("Could not create region file %s: %s", region->path,
+                 strerror(errno));
+        return false;
+    }
+    if (!fe__region_remap(region))
+        return false;
+
+    struct fe__region_header_t* header = fe__region_header(region);
+    memcpy(header->magic, FE_REGION_MAGIC, sizeof header->magic);
+    header->version = FE_REGION_VERSION;
+    header->chunk_size[0] = region->chunk_size.x;
+    header->chunk_size[1] = region->chunk_size.y;
+    header->chunk_size[2] = region->chunk_size.z;
+    header->generator = region->generator;
+    return true;
+}
+
+struct Region* Region__open(const char* path, struct Size3D chunk_size,
+                            uint32_t generator) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        FE_ERROR("Could not open region file %s: %s", path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+
+    struct Region* region = malloc(sizeof *region);
+    if (!region) {
+        FE_FATAL("Could not allocate %lu bytes for region.", sizeof *region);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    *region = (struct Region){
+        .path = fe__region_strdup(path), .fd = fd, .chunk_size = chunk_size,
+        .generator = generator, .file_bytes = (size_t)st.st_size };
+
+    if (st.st_size == 0) {
+        if (!fe__region_reset(region)) {
+            fe__region_free(region);
+            return NULL;
+        }
+        return region;
+    }
+
+    if (region->file_bytes < sizeof (struct fe__region_header_t)) {
+        FE_ERROR("%s is too short to be a region file.", path);
+        fe__region_free(region);
+        return NULL;
+    }
+
+    if (!fe__region_remap(region)) {
+        fe__region_free(region);
+        return NULL;
+    }
+
+    struct fe__region_header_t* header = fe__region_header(region);
+    if (memcmp(header->magic, FE_REGION_MAGIC, sizeof header->magic)
+        || header->version != FE_REGION_VERSION
+        || header->chunk_size[0] != chunk_size.x
+        || header->chunk_size[1] != chunk_size.y
+        || header->chunk_size[2] != chunk_size.z) {
+        FE_ERROR("%s is not a version %d region of (%u, %u, %u) chunks.",
+                 path, FE_REGION_VERSION, chunk_size.x, chunk_size.y,
+                 chunk_size.z);
+        fe__region_free(region);
+        return NULL;
+    }
+
+    if (header->generator != generator) {
+        FE_INFO("Discarding stale region %s, generated by %08x rather "
+                "than %08x.", path, header->generator, generator);
+        if (!fe__region_reset(region)) {
+            fe__region_free(region);
+            return NULL;
+        }
+    }
+
+    return region;
+}
+
+size_t Region_index(struct ChunkCoord coord) {
+    return (size_t)fe__region_mod(coord.x, FE_REGION_SIZE)
+        + (size_t)fe__region_mod(coord.z, FE_REGION_SIZE) * FE_REGION_SIZE
+        + (size_t)fe__region_mod(coord.y, FE_REGION_HEIGHT)
+            * FE_REGION_SIZE * FE_REGION_SIZE;
+}
+
+bool Region_contains(const struct Region* region, size_t index) {
+    return index < FE_REGION_CHUNKS
+        && fe__region_header(region)->entries[index].offset != 0;
+}
+
+/**
+ * @brief Position of the voxel at `idx` in the storage of `chunk`, which
+ * may be const unlike with `Chunk_get_iaspos()`.
+ */
+static inline struct Size3D fe__region_voxel_pos(const struct Chunk* chunk,
+                                                 size_t idx) {
+    if (chunk->layout == CHUNK_LAYOUT_MORTON)
+        return Chunk_morton_decode(idx);
+
+    size_t area = (size_t)chunk->size.x * chunk->size.y;
+    return (struct Size3D){
+        (uint32_t)(idx % chunk->size.x),
+        (uint32_t)(idx % area / chunk->size.x),
+        (uint32_t)(idx / area) };
+}
+
+static void fe__region_put(struct fe__region_buf_t* buf, const void* data,
+                           size_t bytes) {
+    if (buf->len + bytes > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 256;
+        while (cap < buf->len + bytes)
+            cap *= 2;
+
+        uint8_t* grown = realloc(buf->data, cap);
+        if (!grown) {
+            FE_FATAL("Could not allocate %lu bytes for chunk payload.", cap);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+        buf->data = grown;
+        buf->cap = cap;
+    }
+
+    memcpy(buf->data + buf->len, data, bytes);
+    buf->len += bytes;
+}
+
+static void fe__region_put_run(struct fe__region_buf_t* buf, uint16_t type,
+                               size_t len) {
+    uint8_t bytes[2 + 10];
+    size_t n = 0;
+    memcpy(bytes, &type, sizeof type);
+    n += sizeof type;
+    do {
+        bytes[n++] = (uint8_t)(len & 0x7F) | (len > 0x7F ? 0x80 : 0);
+        len >>= 7;
+    } while (len > 0);
+    fe__region_put(buf, bytes, n);
+}
+
+static bool fe__region_get_run(const uint8_t** data, const uint8_t* end,
+                               uint16_t* type, size_t* len) {
+    const uint8_t* p = *data;
+    if ((size_t)(end - p) < sizeof *type)
+        return false;
+    memcpy(type, p, sizeof *type);
+    p += sizeof *type;
+
+    *len = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+        if (p == end || shift >= 64)
+            return false;
+        uint8_t byte = *p++;
+        *len |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+
+    *data = p;
+    return true;
+}
+
+/**
+ * @brief Run-length encodes the voxel types of `chunk` in its storage
+ * order, so that Morton chunks keep their spatially coherent runs.
+ */
+static void fe__region_encode(const struct Chunk* chunk,
+                              struct fe__region_buf_t* buf) {
+    struct fe__region_payload_t head = {
+        .storage = (uint8_t)chunk->storage, .layout = (uint8_t)chunk->layout,
+        .scale = chunk->scale };
+    fe__region_put(buf, &head, sizeof head);
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    if (chunk->uniform) {
+        fe__region_put_run(buf, chunk->uniform_type, voxel_len);
+        head.runs = 1;
+    } else {
+        uint16_t type = Chunk_get_type(chunk, fe__region_voxel_pos(chunk, 0));
+        size_t len = 1;
+        for (size_t i = 1; i < voxel_len; ++i) {
+            uint16_t next = Chunk_get_type(chunk,
+                                           fe__region_voxel_pos(chunk, i));
+            if (next == type) {
+                ++len;
+                continue;
+            }
+            fe__region_put_run(buf, type, len);
+            ++head.runs;
+            type = next;
+            len = 1;
+        }
+        fe__region_put_run(buf, type, len);
+        ++head.runs;
+    }
+
+    memcpy(buf->data, &head, sizeof head);
+}
+
+static bool fe__region_decode(const struct Region* region,
+                              const uint8_t* data, size_t bytes,
+                              struct Chunk* chunk) {
+    struct fe__region_payload_t head;
+    if (bytes < sizeof head)
+        return false;
+    memcpy(&head, data, sizeof head);
+    if (head.storage > CHUNK_STORAGE_PALETTE
+        || head.layout > CHUNK_LAYOUT_MORTON || head.runs == 0)
+        return false;
+
+    const uint8_t* p = data + sizeof head;
+    const uint8_t* end = data + bytes;
+    uint16_t type;
+    size_t len;
+    if (!fe__region_get_run(&p, end, &type, &len))
+        return false;
+
+    // single run chunks come back uniform, without any storage
+    *chunk = Chunk__create_uniform(region->chunk_size, head.storage,
+                                   head.runs == 1 ? type : CHUNK_VOXEL_AIR);
+    chunk->scale = head.scale;
+    if (head.layout != CHUNK_LAYOUT_LINEAR
+        && !Chunk_set_layout(chunk, head.layout)) {
+        Chunk_destroy(chunk);
+        return false;
+    }
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    size_t i = 0;
+    for (uint32_t run = 0; ; ) {
+        if (len > voxel_len - i)
+            break;
+        if (head.runs > 1 && type != CHUNK_VOXEL_AIR)
+            Chunk_set_run(chunk, i, len, type);
+        i += len;
+
+        if (++run == head.runs || !fe__region_get_run(&p, end, &type, &len))
+            break;
+    }
+
+    if (i != voxel_len || p != end) {
+        Chunk_destroy(chunk);
+        return false;
+    }
+    return true;
+}
+
+bool Region_load(struct Region* region, size_t index, struct Chunk* chunk) {
+    if (!Region_contains(region, index))
+        return false;
+
+    struct fe__region_entry_t entry = fe__region_header(region)->entries[index];
+    size_t end = (size_t)entry.offset + entry.bytes;
+    if (end > region->map_bytes && !fe__region_remap(region))
+        return false;
+
+    if (end > region->map_bytes
+        || !fe__region_decode(region, region->map + entry.offset,
+                              entry.bytes, chunk)) {
+        FE_ERROR("Chunk %lu of region file %s is corrupt.", index,
+                 region->path);
+        return false;
+    }
+    return true;
+}
+
+bool Region_save(struct Region* region, size_t index,
+                 const struct Chunk* chunk) {
+    if (index >= FE_REGION_CHUNKS) {
+        FE_WARNING("Warning: region index %lu out of range.", index);
+        return false;
+    }
+    if (chunk->size.x != region->chunk_size.x
+        || chunk->size.y != region->chunk_size.y
+        || chunk->size.z != region->chunk_size.z) {
+        FE_WARNING("Chunk size does not match region file %s, not saving.",
+                   region->path);
+        return false;
+    }
+
+    struct fe__region_buf_t buf = { 0 };
+    fe__region_encode(chunk, &buf);
+
+    // entries address payloads with 32 bits
+    if (region->file_bytes + buf.len > UINT32_MAX) {
+        Region_compact(region);
+        if (region->file_bytes + buf.len > UINT32_MAX) {
+            FE_ERROR("Region file %s is full.", region->path);
+            free(buf.data);
+            return false;
+        }
+    }
+
+    size_t offset = region->file_bytes;
+    if (!fe__region_write(region->fd, buf.data, buf.len, offset)) {
+        FE_ERROR("Could not write to region file %s: %s", region->path,
+                 strerror(errno));
+        free(buf.data);
+        return false;
+    }
+    region->file_bytes += buf.len;
+
+    struct fe__region_header_t* header = fe__region_header(region);
+    struct fe__region_entry_t* entry = header->entries + index;
+    header->live_bytes = header->live_bytes - entry->bytes + buf.len;
+    *entry = (struct fe__region_entry_t){
+        .offset = (uint32_t)offset, .bytes = (uint32_t)buf.len };
+    free(buf.data);
+
+    size_t dead = region->file_bytes - sizeof *header - header->live_bytes;
+    if (dead > header->live_bytes && dead >= FE_REGION_COMPACT_MIN_BYTES)
+        Region_compact(region);
+    return true;
+}
+
+bool Region_compact(struct Region* region) {
+    if (region->map_bytes < region->file_bytes && !fe__region_remap(region))
+        return false;
+
+    size_t tmp_bytes = strlen(region->path) + sizeof ".tmp";
+    char* tmp = malloc(tmp_bytes);
+    struct fe__region_header_t* header = malloc(sizeof *header);
+    if (!tmp || !header) {
+        FE_FATAL("Could not allocate %lu bytes for region compaction.",
+                 tmp_bytes + sizeof *header);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    snprintf(tmp, tmp_bytes, "%s.tmp", region->path);
+
+    int fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0;
+
+    // live payloads are copied in table order, after a fresh table
+    *header = *fe__region_header(region);
+    size_t offset = sizeof *header;
+    for (size_t i = 0; ok && i < FE_REGION_CHUNKS; ++i) {
+        struct fe__region_entry_t* entry = header->entries + i;
+        if (!entry->offset)
+            continue;
+
+        ok = fe__region_write(fd, region->map + entry->offset, entry->bytes,
+                              offset);
+        entry->offset = (uint32_t)offset;
+        offset += entry->bytes;
+    }
+    header->live_bytes = offset - sizeof *header;
+
+    ok = ok && fe__region_write(fd, header, sizeof *header, 0)
+        && fsync(fd) == 0 && rename(tmp, region->path) == 0;
+    free(header);
+    if (!ok) {
+        FE_ERROR("Could not compact region file %s: %s", region->path,
+                 strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp);
+        }
+        free(tmp);
+        return false;
+    }
+    free(tmp);
+
+    FE_DEBUG("Compacted region file %s from %lu to %lu bytes.", region->path,
+             region->file_bytes, offset);
+    munmap(region->map, region->map_bytes);
+    close(region->fd);
+    region->map = NULL;
+    region->fd = fd;
+    region->file_bytes = offset;
+    return fe__region_remap(region);
+}
+
+void Region_sync(struct Region* region) {
+    if (region->map)
+        msync(region->map, region->map_bytes, MS_SYNC);
+    fsync(region->fd);
+}
+
+void Region_close(struct Region* region) {
+    if (!region) {
+        FE_WARNING("Warning: NULL region passed to `Region_close`");
+        return;
+    }
+
+    Region_sync(region);
+    fe__region_free(region);
+}
+
+struct RegionStore RegionStore__create(const char* dir,
+                                       struct Size3D chunk_size,
+                                       uint32_t generator) {
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        FE_ERROR("Could not create region directory %s: %s", dir,
+                 strerror(errno));
+    }
+    return (struct RegionStore){
+        .dir = fe__region_strdup(dir), .chunk_size = chunk_size,
+        .generator = generator };
+}
+
+/**
+ * @brief Returns the region holding the chunk at `coord`, opening it (and
+ * closing the least recently used region if too many are open) if needed.
+ */
+static struct Region* fe__region_store_get(struct RegionStore* store,
+                                           struct ChunkCoord coord) {
+    struct ChunkCoord rc = {
+        fe__region_div(coord.x, FE_REGION_SIZE),
+        fe__region_div(coord.y, FE_REGION_HEIGHT),
+        fe__region_div(coord.z, FE_REGION_SIZE) };
+    ++store->tick;
+
+    size_t lru = 0;
+    for (size_t i = 0; i < store->open_count; ++i) {
+        if (store->open[i].coord.x == rc.x && store->open[i].coord.y == rc.y
+            && store->open[i].coord.z == rc.z) {
+            store->open[i].used = store->tick;
+            return store->open[i].region;
+        }
+        if (store->open[i].used < store->open[lru].used)
+            lru = i;
+    }
+
+    size_t path_bytes = strlen(store->dir) + 64;
+    char* path = malloc(path_bytes);
+    if (!path) {
+        FE_FATAL("Could not allocate %lu bytes for region path.", path_bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    snprintf(path, path_bytes, "%s/r.%d.%d.%d.fer", store->dir,
+             rc.x, rc.y, rc.z);
+    struct Region* region = Region__open(path, store->chunk_size,
+                                         store->generator);
+    free(path);
+    if (!region)
+        return NULL;
+
+    size_t slot = lru;
+    if (store->open_count < FE_REGION_MAX_OPEN)
+        slot = store->open_count++;
+    else
+        Region_close(store->open[slot].region);
+
+    store->open[slot].coord = rc;
+    store->open[slot].region = region;
+    store->open[slot].used = store->tick;
+    return region;
+}
+
+bool RegionStore_load(struct RegionStore* store, struct ChunkCoord coord,
+                      struct Chunk* chunk) {
+    struct Region* region = fe__region_store_get(store, coord);
+    return region && Region_load(region, Region_index(coord), chunk);
+}
+
+bool RegionStore_save(struct RegionStore* store, struct ChunkCoord coord,
+                      const struct Chunk* chunk) {
+    struct Region* region = fe__region_store_get(store, coord);
+    return region && Region_save(region, Region_index(coord), chunk);
+}
+
+void RegionStore_sync(struct RegionStore* store) {
+    for (size_t i = 0; i < store->open_count; ++i)
+        Region_sync(store->open[i].region);
+}
+
+void RegionStore_destroy(struct RegionStore* store) {
+    if (!store) {
+        FE_WARNING("Warning: NULL store passed to `RegionStore_destroy`");
+        return;
+    }
+
+    for (size_t i = 0; i < store->open_count; ++i)
+        Region_close(store->open[i].region);
+    free(store->dir);
+    *store = (struct RegionStore){ 0 };
+}
@@ -0,0 +1,264 @@
+#include <fe/noise.h>
+
+/*
+ * Simplex noise after Stefan Gustavson's "Simplex noise demystified"
+ * (2005): the input is skewed onto a lattice of simplices, and only the
+ * corners of the simplex holding the point contribute, each with a
+ * radially decaying kernel. Corners are hashed through the permutation
+ * table of noise1234.c and use the same gradients as its Perlin noise.
+ */
+
+// the permutation table of noise1234.c, which its header does not export
+extern unsigned char perm[];
+
+// skew and unskew factors, (sqrt(n + 1) - 1) / n and (1 - 1 / sqrt(n + 1)) / n
+#define FE_SIMPLEX_F2 0.366025403f
+#define FE_SIMPLEX_G2 0.211324865f
+#define FE_SIMPLEX_F3 0.333333333f
+#define FE_SIMPLEX_G3 0.166666667f
+#define FE_SIMPLEX_F4 0.309016994f
+#define FE_SIMPLEX_G4 0.138196601f
+
+static inline int fe__simplex_floor(float x) {
+    int i = (int)x;
+    return (float)i <= x ? i : i - 1;
+}
+
+static inline float fe__simplex_grad2(int hash, float x, float y) {
+    int h = hash & 7;
+    float u = h < 4 ? x : y;
+    float v = h < 4 ? y : x;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+}
+
+static inline float fe__simplex_grad3(int hash, float x, float y, float z) {
+    int h = hash & 15;
+    float u = h < 8 ? x : y;
+    float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+static inline float fe__simplex_grad4(int hash, float x, float y, float z,
+                                      float w) {
+    int h = hash & 31;
+    float u = h < 24 ? x : y;
+    float v = h < 16 ? y : z;
+    float t = h < 8 ? z : w;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v) + ((h & 4) ? -t : t);
+}
+
+float simplex2(float x, float y) {
+    // skew to find the cell, then which of its two triangles holds the point
+    float s = (x + y) * FE_SIMPLEX_F2;
+    int i = fe__simplex_floor(x + s);
+    int j = fe__simplex_floor(y + s);
+    float t = (float)(i + j) * FE_SIMPLEX_G2;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+
+    int i1 = x0 > y0;
+    int j1 = !i1;
+
+    float x1 = x0 - (float)i1 + FE_SIMPLEX_G2;
+    float y1 = y0 - (float)j1 + FE_SIMPLEX_G2;
+    float x2 = x0 - 1.0f + 2.0f * FE_SIMPLEX_G2;
+    float y2 = y0 - 1.0f + 2.0f * FE_SIMPLEX_G2;
+
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+
+    float n = 0.0f;
+    float t0 = 0.5f - x0 * x0 - y0 * y0;
+    if (t0 > 0.0f) {
+        t0 *= t0;
+        n += t0 * t0 * fe__simplex_grad2(perm[ii + perm[jj]], x0, y0);
+    }
+    float t1 = 0.5f - x1 * x1 - y1 * y1;
+    if (t1 > 0.0f) {
+        t1 *= t1;
+        n += t1 * t1 * fe__simplex_grad2(perm[ii + i1 + perm[jj + j1]],
+                                         x1, y1);
+    }
+    float t2 = 0.5f - x2 * x2 - y2 * y2;
+    if (t2 > 0.0f) {
+        t2 *= t2;
+        n += t2 * t2 * fe__simplex_grad2(perm[ii + 1 + perm[jj + 1]], x2, y2);
+    }
+
+    return 40.0f * n;
+}
+
+float simplex3(float x, float y, float z) {
+    float s = (x + y + z) * FE_SIMPLEX_F3;
+    int i = fe__simplex_floor(x + s);
+    int j = fe__simplex_floor(y + s);
+    int k = fe__simplex_floor(z + s);
+    float t = (float)(i + j + k) * FE_SIMPLEX_G3;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+    float z0 = z - ((float)k - t);
+
+    // the tetrahedron holding the point follows the order of x0, y0, z0
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0) {
+        if (y0 >= z0) {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        } else if (x0 >= z0) {
+            i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1;
+        } else {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1;
+        }
+    } else {
+        if (y0 < z0) {
+            i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1;
+        } else if (x0 < z0) {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1;
+        } else {
+            i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0;
+        }
+    }
+
+    float x1 = x0 - (float)i1 + FE_SIMPLEX_G3;
+    float y1 = y0 - (float)j1 + FE_SIMPLEX_G3;
+    float z1 = z0 - (float)k1 + FE_SIMPLEX_G3;
+    float x2 = x0 - (float)i2 + 2.0f * FE_SIMPLEX_G3;
+    float y2 = y0 - (float)j2 + 2.0f * FE_SIMPLEX_G3;
+    float z2 = z0 - (float)k2 + 2.0f * FE_SIMPLEX_G3;
+    float x3 = x0 - 1.0f + 3.0f * FE_SIMPLEX_G3;
+    float y3 = y0 - 1.0f + 3.0f * FE_SIMPLEX_G3;
+    float z3 = z0 - 1.0f + 3.0f * FE_SIMPLEX_G3;
+
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+
+    float n = 0.0f;
+    float t0 = 0.6f - x0 * x0 - y0 * y0 - z0 * z0;
+    if (t0 > 0.0f) {
+        t0 *= t0;
+        n += t0 * t0 * fe__simplex_grad3(perm[ii + perm[jj + perm[kk]]],
+                                         x0, y0, z0);
+    }
+    float t1 = 0.6f - x1 * x1 - y1 * y1 - z1 * z1;
+    if (t1 > 0.0f) {
+        t1 *= t1;
+        n += t1 * t1 * fe__simplex_grad3(
+            perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]], x1, y1, z1);
+    }
+    float t2 = 0.6f - x2 * x2 - y2 * y2 - z2 * z2;
+    if (t2 > 0.0f) {
+        t2 *= t2;
+        n += t2 * t2 * fe__simplex_grad3(
+            perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]], x2, y2, z2);
+    }
+    float t3 = 0.6f - x3 * x3 - y3 * y3 - z3 * z3;
+    if (t3 > 0.0f) {
+        t3 *= t3;
+        n += t3 * t3 * fe__simplex_grad3(
+            perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]], x3, y3, z3);
+    }
+
+    return 32.0f * n;
+}
+
+float simplex4(float x, float y, float z, float w) {
+    float s = (x + y + z + w) * FE_SIMPLEX_F4;
+    int i = fe__simplex_floor(x + s);
+    int j = fe__simplex_floor(y + s);
+    int k = fe__simplex_floor(z + s);
+    int l = fe__simplex_floor(w + s);
+    float t = (float)(i + j + k + l) * FE_SIMPLEX_G4;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+    float z0 = z - ((float)k - t);
+    float w0 = w - ((float)l - t);
+
+    // rank the offsets: the simplex steps along the largest one first
+    int rank_x = 0, rank_y = 0, rank_z = 0, rank_w = 0;
+    if (x0 > y0) ++rank_x; else ++rank_y;
+    if (x0 > z0) ++rank_x; else ++rank_z;
+    if (x0 > w0) ++rank_x; else ++rank_w;
+    if (y0 > z0) ++rank_y; else ++rank_z;
+    if (y0 > w0) ++rank_y; else ++rank_w;
+    if (z0 > w0) ++rank_z; else ++rank_w;
+
+    int i1 = rank_x >= 3, j1 = rank_y >= 3, k1 = rank_z >= 3, l1 = rank_w >= 3;
+    int i2 = rank_x >= 2, j2 = rank_y >= 2, k2 = rank_z >= 2, l2 = rank_w >= 2;
+    int i3 = rank_x >= 1, j3 = rank_y >= 1, k3 = rank_z >= 1, l3 = rank_w >= 1;
+
+    float x1 = x0 - (float)i1 + FE_SIMPLEX_G4;
+    float y1 = y0 - (float)j1 + FE_SIMPLEX_G4;
+    float z1 = z0 - (float)k1 + FE_SIMPLEX_G4;
+    float w1 = w0 - (float)l1 + FE_SIMPLEX_G4;
+    float x2 = x0 - (float)i2 + 2.0f * FE_SIMPLEX_G4;
+    float y2 = y0 - (float)j2 + 2.0f * FE_SIMPLEX_G4;
+    float z2 = z0 - (float)k2 + 2.0f * FE_SIMPLEX_G4;
+    float w2 = w0 - (float)l2 + 2.0f * FE_SIMPLEX_G4;
+    float x3 = x0 - (float)i3 + 3.0f * FE_SIMPLEX_G4;
+    float y3 = y0 - (float)j3 + 3.0f * FE_SIMPLEX_G4;
+    float z3 = z0 - (float)k3 + 3.0f * FE_SIMPLEX_G4;
+    float w3 = w0 - (float)l3 + 3.0f * FE_SIMPLEX_G4;
+    float x4 = x0 - 1.0f + 4.0f * FE_SIMPLEX_G4;
+    float y4 = y0 - 1.0f + 4.0f * FE_SIMPLEX_G4;
+    float z4 = z0 - 1.0f + 4.0f * FE_SIMPLEX_G4;
+    float w4 = w0 - 1.0f + 4.0f * FE_SIMPLEX_G4;
+
+    int ii = i & 0xff;
+    int jj = j & 0xff;
+    int kk = k & 0xff;
+    int ll = l & 0xff;
+
+    float n = 0.0f;
+    float t0 = 0.6f - x0 * x0 - y0 * y0 - z0 * z0 - w0 * w0;
+    if (t0 > 0.0f) {
+        t0 *= t0;
+        n += t0 * t0 * fe__simplex_grad4(
+            perm[ii + perm[jj + perm[kk + perm[ll]]]], x0, y0, z0, w0);
+    }
+    float t1 = 0.6f - x1 * x1 - y1 * y1 - z1 * z1 - w1 * w1;
+    if (t1 > 0.0f) {
+        t1 *= t1;
+        n += t1 * t1 * fe__simplex_grad4(
+            perm[ii + i1 + perm[jj + j1 + perm[kk + k1 + perm[ll + l1]]]],
+            x1, y1, z1, w1);
+    }
+    float t2 = 0.6f - x2 * x2 - y2 * y2 - z2 * z2 - w2 * w2;
+    if (t2 > 0.0f) {
+        t2 *= t2;
+        n += t2 * t2 * fe__simplex_grad4(
+            perm[ii + i2 + perm[jj + j2 + perm[kk + k2 + perm[ll + l2]]]],
+            x2, y2, z2, w2);
+    }
+    float t3 = 0.6f - x3 * x3 - y3 * y3 - z3 * z3 - w3 * w3;
+    if (t3 > 0.0f) {
+        t3 *= t3;
+        n += t3 * t3 * fe__simplex_grad4(
+            perm[ii + i3 + perm[jj + j3 + perm[kk + k3 + perm[ll + l3]]]],
+            x3, y3, z3, w3);
+    }
+    float t4 = 0.6f - x4 * x4 - y4 * y4 - z4 * z4 - w4 * w4;
+    if (t4 > 0.0f) {
+        t4 *= t4;
+        n += t4 * t4 * fe__simplex_grad4(
+            perm[ii + 1 + perm[jj + 1 + perm[kk + 1 + perm[ll + 1]]]],
+            x4, y4, z4, w4);
+    }
+
+    return 27.0f * n;
+}
+
+void simplex3_grid(float* out, struct Size3D size, const float* xs,
+                   const float* ys, const float* zs) {
+    for (size_t k = 0; k < size.z; ++k)
+        for (size_t j = 0; j < size.y; ++j)
+            for (size_t i = 0; i < size.x; ++i)
+                *out++ = simplex3(xs[i], ys[j], zs[k]);
+}
+
+void simplex4_grid(float* out, struct Size3D size, const float* xs,
+                   const float* ys, const float* zs, float w) {
+    for (size_t k = 0; k < size.z; ++k)
+        for (size_t j = 0; j < size.y; ++j)
+            for (size_t i = 0; i < size.x; ++i)
+                *out++ = simplex4(xs[i], ys[j], zs[k], w);
+}
@@ -0,0 +1,570 @@
+#include <fe/stream.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <math.h>
+
+// indexed by `enum ChunkFace`, as in vchunk.c
+static const int32_t fe__stream_face_dirs[CHUNK_FACE_COUNT][3] = {
+    [CHUNK_FACE_NEG_Z] = {  0,  0, -1 },
+    [CHUNK_FACE_POS_X] = {  1,  0,  0 },
+    [CHUNK_FACE_POS_Z] = {  0,  0,  1 },
+    [CHUNK_FACE_NEG_X] = { -1,  0,  0 },
+    [CHUNK_FACE_POS_Y] = {  0,  1,  0 },
+    [CHUNK_FACE_NEG_Y] = {  0, -1,  0 },
+};
+
+static int fe__stream_offset_cmp(const void* a, const void* b) {
+    float da = ((const struct fe__stream_offset_t*)a)->distance;
+    float db = ((const struct fe__stream_offset_t*)b)->distance;
+    return (da > db) - (da < db);
+}
+
+static inline int64_t fe__stream_distance2(struct ChunkCoord a,
+                                           struct ChunkCoord b) {
+    int64_t dx = (int64_t)a.x - b.x;
+    int64_t dy = (int64_t)a.y - b.y;
+    int64_t dz = (int64_t)a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+static void* fe__stream_alloc(size_t bytes) {
+    void* data = malloc(bytes);
+    if (!data) {
+        FE_FATAL("Could not allocate %lu bytes for chunk stream.", bytes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    return data;
+}
+
+/**
+ * @brief Inserts `pick` into `picks`, which holds the `*len` lowest
+ * priority picks seen so far in order, keeping at most `max`.
+ */
+static void fe__stream_pick(struct fe__stream_pick_t* picks, size_t* len,
+                            size_t max, struct fe__stream_pick_t pick) {
+    if (max == 0 || (*len == max && picks[max - 1].priority <= pick.priority))
+        return;
+
+    size_t i = *len < max ? (*len)++ : max - 1;
+    while (i > 0 && picks[i - 1].priority > pick.priority) {
+        picks[i] = picks[i - 1];
+        --i;
+    }
+    picks[i] = pick;
+}
+
+/**
+ * A chunk handed to a generation worker. Finished jobs are chained in 
+ * their queue's done list.
+ */
+struct fe__generate_job_t {
+    struct ChunkGenerateQueue* queue;
+    struct ChunkCoord coord;
+    struct Chunk chunk;
+    struct fe__generate_job_t* next;
+};
+
+static void fe__generate_job_run(void* arg) {
+    struct fe__generate_job_t* job = arg;
+    struct ChunkGenerateQueue* queue = job->queue;
+
+    job->chunk = queue->generate(job->coord, queue->user);
+
+    pthread_mutex_lock(&queue->lock);
+    if (queue->done_tail)
+        queue->done_tail->next = job;
+    else
+        queue->done_head = job;
+    queue->done_tail = job;
+    --queue->running;
+    pthread_cond_broadcast(&queue->finished);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+struct ChunkGenerateQueue* ChunkGenerateQueue__create(struct JobPool* pool,
+                                                      ChunkGenerateFn generate,
+                                                      void* user) {
+    struct ChunkGenerateQueue* queue = calloc(1, sizeof *queue);
+    if (!queue) {
+        FE_FATAL("Could not allocate %lu bytes for chunk generate queue.",
+                 sizeof *queue);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    queue->pool = pool;
+    queue->generate = generate;
+    queue->user = user;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->finished, NULL);
+    return queue;
+}
+
+void ChunkGenerateQueue_submit(struct ChunkGenerateQueue* queue,
+                               struct ChunkCoord coord) {
+    struct fe__generate_job_t* job = fe__stream_alloc(sizeof *job);
+    *job = (struct fe__generate_job_t){ .queue = queue, .coord = coord };
+
+    pthread_mutex_lock(&queue->lock);
+    ++queue->running;
+    ++queue->pending;
+    pthread_mutex_unlock(&queue->lock);
+
+    JobPool_submit(queue->pool, fe__generate_job_run, job);
+}
+
+size_t ChunkGenerateQueue_poll(struct ChunkGenerateQueue* queue,
+                               struct ChunkGenerateResult* results,
+                               size_t max) {
+    size_t count = 0;
+    pthread_mutex_lock(&queue->lock);
+    while (count < max && queue->done_head) {
+        struct fe__generate_job_t* job = queue->done_head;
+        queue->done_head = job->next;
+        if (!queue->done_head)
+            queue->done_tail = NULL;
+        --queue->pending;
+
+        results[count++] = (struct ChunkGenerateResult){
+            .coord = job->coord, .chunk = job->chunk };
+        free(job);
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return count;
+}
+
+size_t ChunkGenerateQueue_pending(struct ChunkGenerateQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    size_t pending = queue->pending;
+    pthread_mutex_unlock(&queue->lock);
+    return pending;
+}
+
+void ChunkGenerateQueue_destroy(struct ChunkGenerateQueue* queue) {
+    if (!queue) {
+        FE_WARNING("Warning: NULL queue passed to `ChunkGenerateQueue_destroy`");
+        return;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->running > 0)
+        pthread_cond_wait(&queue->finished, &queue->lock);
+    pthread_mutex_unlock(&queue->lock);
+
+    while (queue->done_head) {
+        struct fe__generate_job_t* job = queue->done_head;
+        queue->done_head = job->next;
+        Chunk_destroy(&job->chunk);
+        free(job);
+    }
+
+    pthread_cond_destroy(&queue->finished);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
+}
+
+struct ChunkStream ChunkStream__create(struct World* world,
+                                       struct JobPool* pool,
+                                       struct ChunkStreamOptions options) {
+    if (options.load_radius < 0)
+        options.load_radius = 0;
+    if (options.unload_radius <= options.load_radius) {
+        FE_WARNING("Unload radius %d is within load radius %d, using %d.",
+                   options.unload_radius, options.load_radius,
+                   options.load_radius + 1);
+        options.unload_radius = options.load_radius + 1;
+    }
+
+    struct ChunkStream stream = {
+        .world = world,
+        .queue = ChunkMeshQueue__create(pool),
+        .options = options };
+    if (options.max_generating > 0)
+        stream.generate_queue = ChunkGenerateQueue__create(
+            pool, options.generate, options.user);
+
+    int32_t r = options.load_radius;
+    size_t side = (size_t)(2 * r + 1);
+    stream.offsets = fe__stream_alloc(side * side * side
+                                      * sizeof *stream.offsets);
+    for (int32_t z = -r; z <= r; ++z)
+    for (int32_t y = -r; y <= r; ++y)
+    for (int32_t x = -r; x <= r; ++x) {
+        struct ChunkCoord offset = { x, y, z };
+        int64_t d2 = fe__stream_distance2(offset, (struct ChunkCoord){ 0 });
+        if (d2 > (int64_t)r * r)
+            continue;
+        stream.offsets[stream.offset_count++] = (struct fe__stream_offset_t){
+            .offset = offset, .distance = sqrtf((float)d2) };
+    }
+    qsort(stream.offsets, stream.offset_count, sizeof *stream.offsets,
+          fe__stream_offset_cmp);
+
+    stream.picks = fe__stream_alloc((options.max_loads + options.max_meshing
+                                     + 1) * sizeof *stream.picks);
+
+    return stream;
+}
+
+static void fe__stream_push_unload(struct ChunkStream* stream, size_t* count,
+                                   struct ChunkCoord coord) {
+    if (*count == stream->unloads_cap) {
+        stream->unloads_cap = stream->unloads_cap
+            ? stream->unloads_cap * 2 : 64;
+        stream->unloads = realloc(stream->unloads, stream->unloads_cap
+                                  * sizeof *stream->unloads);
+        if (!stream->unloads) {
+            FE_FATAL("Could not allocate %lu bytes for chunk stream.",
+                     stream->unloads_cap * sizeof *stream->unloads);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+    }
+    stream->unloads[(*count)++] = coord;
+}
+
+void ChunkStream_destroy(struct ChunkStream* stream) {
+    if (!stream) {
+        FE_WARNING("Warning: NULL stream passed to `ChunkStream_destroy`");
+        return;
+    }
+
+    ChunkMeshQueue_destroy(stream->queue);
+    if (stream->generate_queue)
+        ChunkGenerateQueue_destroy(stream->generate_queue);
+
+    // the meshes and chunks in flight were discarded with the queues
+    size_t count = 0;
+    size_t cursor = 0;
+    for (struct WorldChunk* entry; (entry = World_next(stream->world, &cursor));) {
+        if (entry->meshing) {
+            entry->meshing = false;
+            entry->stale = true;
+        }
+        if (entry->generating)
+            fe__stream_push_unload(stream, &count, entry->coord);
+    }
+    for (size_t i = 0; i < count; ++i)
+        World_remove(stream->world, stream->unloads[i]);
+
+    free(stream->offsets);
+    free(stream->picks);
+    free(stream->unloads);
+}
+
+static void fe__stream_poll(struct ChunkStream* stream) {
+    struct ChunkMeshResult results[16];
+    size_t polled;
+    while ((polled = ChunkMeshQueue_poll(stream->queue, results, 16)) > 0) {
+        for (size_t i = 0; i < polled; ++i) {
+            struct WorldChunk* entry = results[i].user;
+            if (entry->meshed)
+                ChunkMesh_destroy(&entry->mesh);
+            entry->mesh = results[i].mesh;
+            entry->meshed = true;
+            entry->meshing = false;
+        }
+    }
+}
+
+/**
+ * @brief Unloads the chunks past the unload radius. Chunks being meshed
+ * are kept until their mesh is back.
+ * @return Whether every chunk past the radius was unloaded.
+ */
+static bool fe__stream_unload(struct ChunkStream* stream) {
+    struct World* world = stream->world;
+    int64_t radius2 = (int64_t)stream->options.unload_radius
+        * stream->options.unload_radius;
+    size_t count = 0;
+    bool complete = true;
+
+    // removing entries reorders the table, so collect them first
+    size_t cursor = 0;
+    for (struct WorldChunk* entry; (entry = World_next(world, &cursor));) {
+        if (fe__stream_distance2(entry->coord, stream->center) <= radius2)
+            continue;
+        if (entry->meshing) {
+            complete = false;
+            continue;
+        }
+
+        fe__stream_push_unload(stream, &count, entry->coord);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        World_remove(world, stream->unloads[i]);
+    if (count > 0) {
+        FE_DEBUG("Unloaded %lu chunks, %lu left.", count, World_count(world));
+    }
+
+    return complete;
+}
+
+/**
+ * @brief Whether every neighbor of `coord` that will be loaded around the
+ * current center is loaded.
+ */
+static bool fe__stream_neighbors_ready(const struct ChunkStream* stream,
+                                       struct ChunkCoord coord) {
+    int64_t radius2 = (int64_t)stream->options.load_radius
+        * stream->options.load_radius;
+
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const int32_t* dir = fe__stream_face_dirs[face];
+        struct ChunkCoord n = {
+            coord.x + dir[0], coord.y + dir[1], coord.z + dir[2] };
+        if (fe__stream_distance2(n, stream->center) > radius2)
+            continue;
+        struct WorldChunk* entry = World_get(stream->world, n);
+        if (!entry || entry->generating)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Whether a mesh of a neighbor of `coord`, which reads the chunk
+ * at `coord`, is in flight.
+ */
+static bool fe__stream_neighbors_meshing(const struct ChunkStream* stream,
+                                         struct ChunkCoord coord) {
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const int32_t* dir = fe__stream_face_dirs[face];
+        struct WorldChunk* n = World_get(stream->world, (struct ChunkCoord){
+            coord.x + dir[0], coord.y + dir[1], coord.z + dir[2] });
+        if (n && n->meshing)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Compresses the meshed chunks gone cold under the compression
+ * policy, looking at up to `max_compress` entries of the world from where
+ * the previous call stopped.
+ */
+static void fe__stream_compress(struct ChunkStream* stream) {
+    const struct ChunkStreamOptions* options = &stream->options;
+    if (options->compress_radius <= 0 && options->compress_idle == 0)
+        return;
+
+    struct World* world = stream->world;
+    int64_t radius2 = (int64_t)options->compress_radius 
+        * options->compress_radius;
+    size_t count = 0;
+
+    for (size_t i = 0; i < options->max_compress; ++i) {
+        struct WorldChunk* entry = World_next(world, &stream->compress_cursor);
+        if (!entry) {
+            stream->compress_cursor = 0;
+            break;
+        }
+
+        if (entry->cold) {
+            // writes decompress (or promote) chunks, which counts as use 
+            if (entry->compact && !entry->chunk.compressed 
+                && !entry->chunk.uniform) {
+                entry->cold = false;
+                entry->used = stream->tick;
+            }
+            continue;
+        }
+        if (!entry->meshed || entry->meshing || entry->stale)
+            continue;
+
+        bool far = options->compress_radius > 0 
+            && fe__stream_distance2(entry->coord, stream->center) > radius2;
+        bool idle = options->compress_idle > 0 
+            && stream->tick - entry->used >= options->compress_idle;
+        if ((!far && !idle) || fe__stream_neighbors_meshing(stream, entry->coord))
+            continue;
+
+        count += Chunk_compress(&entry->chunk);
+        entry->cold = true;
+        entry->compact = entry->chunk.compressed || entry->chunk.uniform;
+    }
+
+    if (count > 0) {
+        FE_DEBUG("Compressed %lu chunks.", count);
+    }
+}
+
+/**
+ * @brief Inserts the chunk generated for `coord` into the world.
+ */
+static void fe__stream_insert(struct ChunkStream* stream,
+                              struct ChunkCoord coord, struct Chunk chunk) {
+    struct World* world = stream->world;
+    World_insert(world, coord, chunk)->used = stream->tick;
+
+    // neighbors meshed without this chunk have faces against it
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const int32_t* dir = fe__stream_face_dirs[face];
+        struct WorldChunk* n = World_get(world, (struct ChunkCoord){
+            coord.x + dir[0], coord.y + dir[1], coord.z + dir[2] });
+        if (n && (n->meshed || n->meshing))
+            n->stale = true;
+    }
+}
+
+static void fe__stream_load(struct ChunkStream* stream,
+                            struct ChunkCoord coord) {
+    if (!stream->generate_queue) {
+        fe__stream_insert(stream, coord, stream->options.generate(
+            coord, stream->options.user));
+        return;
+    }
+
+    struct World* world = stream->world;
+    struct WorldChunk* entry = World_insert(world, coord, 
+        Chunk__create_uniform(world->chunk_size, CHUNK_STORAGE_VOXELS,
+                              CHUNK_VOXEL_AIR));
+    entry->generating = true;
+    ChunkGenerateQueue_submit(stream->generate_queue, coord);
+}
+
+/**
+ * @brief Inserts the chunks generated on the pool whose placeholder is 
+ * still in the world, and drops the others.
+ */
+static void fe__stream_poll_generated(struct ChunkStream* stream) {
+    if (!stream->generate_queue)
+        return;
+
+    struct ChunkGenerateResult results[16];
+    size_t polled;
+    while ((polled = ChunkGenerateQueue_poll(stream->generate_queue, 
+                                             results, 16)) > 0) {
+        for (size_t i = 0; i < polled; ++i) {
+            struct WorldChunk* entry = World_get(stream->world, 
+                                                 results[i].coord);
+            if (entry && entry->generating)
+                fe__stream_insert(stream, results[i].coord, results[i].chunk);
+            else
+                Chunk_destroy(&results[i].chunk);
+        }
+    }
+}
+
+static void fe__stream_mesh(struct ChunkStream* stream,
+                            struct WorldChunk* entry) {
+    // placeholders hold no voxels yet, the chunk is meshed again once 
+    // they are replaced
+    struct Chunk* neighbors[CHUNK_FACE_COUNT];
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const int32_t* dir = fe__stream_face_dirs[face];
+        struct WorldChunk* n = World_get(stream->world, (struct ChunkCoord){
+            entry->coord.x + dir[0], entry->coord.y + dir[1], 
+            entry->coord.z + dir[2] });
+        neighbors[face] = n && !n->generating ? &n->chunk : NULL;
+    }
+    ChunkMeshQueue_submit(stream->queue, &entry->chunk, neighbors,
+                          stream->options.mesh_options, entry);
+    entry->meshing = true;
+    entry->stale = false;
+    entry->cold = false;
+    entry->used = stream->tick;
+}
+
+void ChunkStream_update(struct ChunkStream* stream, const float camera_pos[3],
+                        const float camera_front[3]) {
+    struct World* world = stream->world;
+    struct ChunkStreamOptions* options = &stream->options;
+
+    fe__stream_poll(stream);
+    ++stream->tick;
+    fe__stream_poll_generated(stream);
+
+    struct ChunkCoord center = {
+        (int32_t)floorf(camera_pos[0] / (float)world->chunk_size.x),
+        (int32_t)floorf(camera_pos[1] / (float)world->chunk_size.y),
+        (int32_t)floorf(camera_pos[2] / (float)world->chunk_size.z) };
+    if (!stream->centered || center.x != stream->center.x
+        || center.y != stream->center.y || center.z != stream->center.z) {
+        stream->center = center;
+        stream->centered = true;
+        stream->settled = false;
+    }
+
+    // cold chunks keep being compressed once everything is loaded 
+    fe__stream_compress(stream);
+    if (stream->settled)
+        return;
+
+    // chunks kept back by a mesh in flight are retried until they are gone
+    bool unloaded = fe__stream_unload(stream);
+
+    float front[3] = { camera_front[0], camera_front[1], camera_front[2] };
+    float front_len = sqrtf(front[0] * front[0] + front[1] * front[1]
+                            + front[2] * front[2]);
+    for (int i = 0; i < 3; ++i)
+        front[i] = front_len > 0.f ? front[i] / front_len : 0.f;
+
+    size_t pending = ChunkMeshQueue_pending(stream->queue);
+    size_t mesh_budget = options->max_meshing > pending
+        ? options->max_meshing - pending : 0;
+
+    size_t load_budget = options->max_loads;
+    size_t generating = 0;
+    if (stream->generate_queue) {
+        generating = ChunkGenerateQueue_pending(stream->generate_queue);
+        size_t free_slots = options->max_generating > generating
+            ? options->max_generating - generating : 0;
+        if (free_slots < load_budget)
+            load_budget = free_slots;
+    }
+
+    struct fe__stream_pick_t* loads = stream->picks;
+    struct fe__stream_pick_t* meshes = stream->picks + options->max_loads;
+    size_t load_count = 0;
+    size_t mesh_count = 0;
+    size_t work = 0;
+
+    for (size_t i = 0; i < stream->offset_count; ++i) {
+        const struct fe__stream_offset_t* offset = &stream->offsets[i];
+        struct ChunkCoord coord = {
+            center.x + offset->offset.x,
+            center.y + offset->offset.y,
+            center.z + offset->offset.z };
+
+        struct WorldChunk* entry = World_get(world, coord);
+        if (entry && entry->generating) {
+            ++work;
+            continue;
+        }
+
+        bool load = !entry;
+        bool mesh = entry && !entry->meshing
+            && (!entry->meshed || entry->stale);
+        if (!load && !mesh)
+            continue;
+        ++work;
+        if (mesh && !fe__stream_neighbors_ready(stream, coord))
+            continue;
+
+        // chunks behind the camera weigh up to twice their distance
+        float facing = 1.f;
+        if (offset->distance > 0.f) {
+            facing = (offset->offset.x * front[0]
+                      + offset->offset.y * front[1]
+                      + offset->offset.z * front[2]) / offset->distance;
+        }
+        struct fe__stream_pick_t pick = {
+            .coord = coord,
+            .priority = offset->distance * (1.5f - 0.5f * facing) };
+
+        if (load)
+            fe__stream_pick(loads, &load_count, load_budget, pick);
+        else
+            fe__stream_pick(meshes, &mesh_count, mesh_budget, pick);
+    }
+
+    for (size_t i = 0; i < mesh_count; ++i)
+        fe__stream_mesh(stream, World_get(world, meshes[i].coord));
+    for (size_t i = 0; i < load_count; ++i)
+        fe__stream_load(stream, loads[i].coord);
+
+    stream->settled = unloaded && work == 0 && pending == 0
+        && generating == 0;
+}
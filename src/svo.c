@@ -0,0 +1,564 @@
+#include <fe/geometries/svo.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#include <math.h>
+#include <string.h>
+
+// as in world.c, grow the lookup once it is 3/4 full
+#define FE_DAG_MAX_LOAD(cap) ((cap) - (cap) / 4)
+
+#define FE_DAG_NO_NODE UINT32_MAX
+
+static inline size_t fe__dag_hash(const uint32_t children[8]) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < 8; ++i)
+        h = (h ^ children[i]) * 0x100000001b3ULL;
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    return (size_t)(h ^ (h >> 32));
+}
+
+static inline size_t fe__dag_child_index(uint32_t x, uint32_t y, uint32_t z,
+                                         uint32_t half) {
+    return (size_t)(x >= half) | (size_t)(y >= half) << 1
+        | (size_t)(z >= half) << 2;
+}
+
+static void fe__dag_lookup_insert(struct VoxelDag* dag, uint32_t node) {
+    size_t mask = dag->lookup_cap - 1;
+    size_t slot = fe__dag_hash(dag->nodes[node].children) & mask;
+    while (dag->lookup[slot])
+        slot = (slot + 1) & mask;
+    dag->lookup[slot] = node + 1;
+}
+
+static void fe__dag_rehash(struct VoxelDag* dag, size_t cap) {
+    uint32_t* lookup = calloc(cap, sizeof *lookup);
+    if (!lookup) {
+        FE_FATAL("Could not allocate %lu bytes for DAG lookup.",
+                 cap * sizeof *lookup);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    free(dag->lookup);
+    dag->lookup = lookup;
+    dag->lookup_cap = cap;
+    for (size_t i = 0; i < dag->len; ++i)
+        fe__dag_lookup_insert(dag, (uint32_t)i);
+}
+
+static void fe__dag_reserve(struct VoxelDag* dag, size_t len) {
+    if (len <= dag->cap)
+        return;
+
+    size_t cap = dag->cap ? dag->cap : 64;
+    while (cap < len)
+        cap *= 2;
+    struct VoxelDagNode* nodes = realloc(dag->nodes, cap * sizeof *nodes);
+    if (!nodes) {
+        FE_FATAL("Could not allocate %lu bytes for DAG nodes.",
+                 cap * sizeof *nodes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    dag->nodes = nodes;
+    dag->cap = cap;
+}
+
+/**
+ * @brief Returns the reference to the subtree of `children`: a leaf if
+ * they are all the same leaf, else the node holding them, created unless
+ * an equal one already exists.
+ */
+static uint32_t fe__dag_make(struct VoxelDag* dag, const uint32_t children[8]) {
+    bool uniform = true;
+    for (size_t i = 1; i < 8 && uniform; ++i)
+        uniform = children[i] == children[0];
+    if (uniform && (children[0] & VOXEL_DAG_LEAF))
+        return children[0];
+
+    if (dag->len + 1 > FE_DAG_MAX_LOAD(dag->lookup_cap))
+        fe__dag_rehash(dag, dag->lookup_cap ? dag->lookup_cap * 2 : 128);
+
+    size_t mask = dag->lookup_cap - 1;
+    size_t slot = fe__dag_hash(children) & mask;
+    for (; dag->lookup[slot]; slot = (slot + 1) & mask) {
+        uint32_t node = dag->lookup[slot] - 1;
+        if (memcmp(dag->nodes[node].children, children,
+                   sizeof dag->nodes[node].children) == 0)
+            return node;
+    }
+
+    if (dag->len >= VOXEL_DAG_LEAF - 1) {
+        FE_FATAL("DAG outgrew %u nodes.", VOXEL_DAG_LEAF - 1);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    fe__dag_reserve(dag, dag->len + 1);
+    uint32_t node = (uint32_t)dag->len++;
+    memcpy(dag->nodes[node].children, children,
+           sizeof dag->nodes[node].children);
+    dag->lookup[slot] = node + 1;
+    return node;
+}
+
+/**
+ * @brief Returns `ref`, a subtree of `side` voxels, with its subtree of
+ * `sub_side` voxels at (x, y, z) replaced by `sub`.
+ */
+static uint32_t fe__dag_graft(struct VoxelDag* dag, uint32_t ref, uint32_t side,
+                              uint32_t x, uint32_t y, uint32_t z,
+                              uint32_t sub_side, uint32_t sub) {
+    if (side == sub_side)
+        return sub;
+
+    // copied, as `dag->nodes` may move while grafting
+    uint32_t children[8];
+    if (ref & VOXEL_DAG_LEAF) {
+        for (size_t i = 0; i < 8; ++i)
+            children[i] = ref;
+    } else {
+        memcpy(children, dag->nodes[ref].children, sizeof children);
+    }
+
+    uint32_t half = side / 2;
+    size_t i = fe__dag_child_index(x, y, z, half);
+    children[i] = fe__dag_graft(dag, children[i], half, x % half, y % half,
+                                z % half, sub_side, sub);
+    return fe__dag_make(dag, children);
+}
+
+/**
+ * @brief Builds the subtree of the `side` voxels of `chunk` from (x, y, z).
+ */
+static uint32_t fe__dag_build(struct VoxelDag* dag, const struct Chunk* chunk,
+                              uint32_t x, uint32_t y, uint32_t z,
+                              uint32_t side) {
+    if (side == 1) {
+        struct Size3D pos = { x, y, z };
+        return VOXEL_DAG_LEAF_REF(Chunk_get_type(chunk, pos));
+    }
+
+    uint32_t half = side / 2;
+    uint32_t children[8];
+    for (size_t i = 0; i < 8; ++i)
+        children[i] = fe__dag_build(dag, chunk,
+                                    x + (i & 1 ? half : 0),
+                                    y + (i & 2 ? half : 0),
+                                    z + (i & 4 ? half : 0), half);
+    return fe__dag_make(dag, children);
+}
+
+struct VoxelDag VoxelDag__create(uint32_t depth) {
+    if (depth > VOXEL_DAG_MAX_DEPTH) {
+        FE_WARNING("Warning: DAG depth %u clamped to %u", depth,
+                   VOXEL_DAG_MAX_DEPTH);
+        depth = VOXEL_DAG_MAX_DEPTH;
+    }
+
+    return (struct VoxelDag){
+        .depth = depth,
+        .root = VOXEL_DAG_LEAF_REF(CHUNK_VOXEL_AIR) };
+}
+
+uint32_t VoxelDag_side(const struct VoxelDag* dag) {
+    return (uint32_t)1 << dag->depth;
+}
+
+uint16_t VoxelDag_get(const struct VoxelDag* dag, struct Size3D pos) {
+    uint32_t side = VoxelDag_side(dag);
+    if (pos.x >= side || pos.y >= side || pos.z >= side)
+        return CHUNK_VOXEL_AIR;
+
+    uint32_t ref = dag->root;
+    while (!(ref & VOXEL_DAG_LEAF)) {
+        side /= 2;
+        ref = dag->nodes[ref].children[
+            fe__dag_child_index(pos.x, pos.y, pos.z, side)];
+        pos.x %= side;
+        pos.y %= side;
+        pos.z %= side;
+    }
+    return (uint16_t)ref;
+}
+
+void VoxelDag_set(struct VoxelDag* dag, struct Size3D pos, uint16_t type) {
+    uint32_t side = VoxelDag_side(dag);
+    if (pos.x >= side || pos.y >= side || pos.z >= side)
+        return;
+    // unchanged voxels would only leave a dead copy of their path
+    if (VoxelDag_get(dag, pos) == type)
+        return;
+
+    dag->root = fe__dag_graft(dag, dag->root, side, pos.x, pos.y, pos.z, 1,
+                              VOXEL_DAG_LEAF_REF(type));
+}
+
+bool VoxelDag_insert_chunk(struct VoxelDag* dag, const struct Chunk* chunk,
+                           struct Size3D origin) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `VoxelDag_insert_chunk`");
+        return false;
+    }
+
+    uint32_t side = chunk->size.x;
+    uint32_t dag_side = VoxelDag_side(dag);
+    if (side == 0 || (side & (side - 1)) || chunk->size.y != side
+        || chunk->size.z != side || side > dag_side) {
+        FE_ERROR("Cannot insert a %ux%ux%u chunk into a DAG of side %u.",
+                 chunk->size.x, chunk->size.y, chunk->size.z, dag_side);
+        return false;
+    }
+    if (origin.x % side || origin.y % side || origin.z % side
+        || origin.x >= dag_side || origin.y >= dag_side
+        || origin.z >= dag_side) {
+        FE_ERROR("Chunk origin (%u, %u, %u) is not aligned within the DAG.",
+                 origin.x, origin.y, origin.z);
+        return false;
+    }
+
+    uint32_t sub = chunk->uniform
+        ? VOXEL_DAG_LEAF_REF(chunk->uniform_type)
+        : fe__dag_build(dag, chunk, 0, 0, 0, side);
+    dag->root = fe__dag_graft(dag, dag->root, dag_side, origin.x, origin.y,
+                              origin.z, side, sub);
+    return true;
+}
+
+/**
+ * @brief Writes the voxels of `ref`, the subtree of `side` voxels from
+ * `lo` in `dag`, that fall within `chunk`, whose first voxel is at
+ * `origin`. `chunk` starts out as air.
+ */
+static void fe__dag_fill(const struct VoxelDag* dag, struct Chunk* chunk,
+                         uint32_t ref, const uint64_t lo[3], uint64_t side,
+                         const uint64_t origin[3]) {
+    uint64_t size[3] = { chunk->size.x, chunk->size.y, chunk->size.z };
+    uint64_t from[3], to[3];
+    for (size_t k = 0; k < 3; ++k) {
+        from[k] = lo[k] > origin[k] ? lo[k] : origin[k];
+        to[k] = lo[k] + side < origin[k] + size[k]
+            ? lo[k] + side : origin[k] + size[k];
+        if (from[k] >= to[k])
+            return;
+    }
+
+    if (ref & VOXEL_DAG_LEAF) {
+        uint16_t type = (uint16_t)ref;
+        if (type == CHUNK_VOXEL_AIR)
+            return;
+
+        for (uint64_t z = from[2]; z < to[2]; ++z) {
+            for (uint64_t y = from[1]; y < to[1]; ++y) {
+                size_t idx = (size_t)(from[0] - origin[0])
+                    + (size_t)(y - origin[1]) * chunk->size.x
+                    + (size_t)(z - origin[2]) * chunk->size.x * chunk->size.y;
+                Chunk_set_run(chunk, idx, (size_t)(to[0] - from[0]), type);
+            }
+        }
+        return;
+    }
+
+    uint64_t half = side / 2;
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t child_lo[3] = {
+            lo[0] + (i & 1 ? half : 0),
+            lo[1] + (i & 2 ? half : 0),
+            lo[2] + (i & 4 ? half : 0) };
+        fe__dag_fill(dag, chunk, dag->nodes[ref].children[i], child_lo, half,
+                     origin);
+    }
+}
+
+struct Chunk VoxelDag_to_chunk(const struct VoxelDag* dag, struct Size3D origin,
+                               struct Size3D size, enum ChunkStorage storage) {
+    uint64_t from[3] = { origin.x, origin.y, origin.z };
+    uint64_t to[3] = {
+        from[0] + size.x, from[1] + size.y, from[2] + size.z };
+
+    // descend to the smallest subtree holding the whole chunk, which is
+    // often a leaf and then the chunk is uniform
+    uint32_t ref = dag->root;
+    uint64_t lo[3] = { 0, 0, 0 };
+    uint64_t side = VoxelDag_side(dag);
+    bool inside = to[0] <= side && to[1] <= side && to[2] <= side;
+    while (inside && !(ref & VOXEL_DAG_LEAF)) {
+        uint64_t half = side / 2;
+        size_t i = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            uint64_t mid = lo[k] + half;
+            if (from[k] >= mid)
+                i |= (size_t)1 << k;
+            else if (to[k] > mid)
+                inside = false;
+        }
+        if (!inside)
+            break;
+
+        for (size_t k = 0; k < 3; ++k)
+            lo[k] += i >> k & 1 ? half : 0;
+        side = half;
+        ref = dag->nodes[ref].children[i];
+    }
+
+    if (inside && (ref & VOXEL_DAG_LEAF))
+        return Chunk__create_uniform(size, storage, (uint16_t)ref);
+
+    struct Chunk chunk = Chunk__create_uniform(size, storage, CHUNK_VOXEL_AIR);
+    fe__dag_fill(dag, &chunk, ref, lo, side, from);
+    return chunk;
+}
+
+struct fe__dag_ray_t {
+    float origin[3];
+    float dir[3];
+    float inv[3];
+    float max_t;
+};
+
+/**
+ * @brief Clips `ray` against the box of `side` voxels from `lo`, setting
+ * `*t` to where the ray enters it (0 if it starts inside) and `*axis` to
+ * the axis of the face it enters through (-1 if it starts inside).
+ * @return false if the ray misses the box within its length.
+ */
+static bool fe__dag_ray_box(const struct fe__dag_ray_t* ray, const float lo[3],
+                            float side, float* t, int* axis) {
+    float t_min = -INFINITY, t_max = INFINITY;
+    int entry = -1;
+    for (int k = 0; k < 3; ++k) {
+        if (ray->dir[k] == 0.0f) {
+            if (ray->origin[k] < lo[k] || ray->origin[k] >= lo[k] + side)
+                return false;
+            continue;
+        }
+
+        float near = (lo[k] - ray->origin[k]) * ray->inv[k];
+        float far = (lo[k] + side - ray->origin[k]) * ray->inv[k];
+        if (near > far) {
+            float swap = near;
+            near = far;
+            far = swap;
+        }
+        if (near > t_min) {
+            t_min = near;
+            entry = k;
+        }
+        if (far < t_max)
+            t_max = far;
+    }
+
+    if (t_min < 0.0f) {
+        t_min = 0.0f;
+        entry = -1;
+    }
+    if (t_min >= t_max || t_min > ray->max_t)
+        return false;
+
+    *t = t_min;
+    *axis = entry;
+    return true;
+}
+
+/**
+ * @brief Finds the first non-air voxel along `ray` within `ref`, the
+ * subtree of `side` voxels from `lo` that the ray enters at `t` through
+ * `axis`. Children are visited front to back.
+ */
+static bool fe__dag_ray_node(const struct VoxelDag* dag,
+                             const struct fe__dag_ray_t* ray, uint32_t ref,
+                             const float lo[3], float side, float t, int axis,
+                             struct VoxelDagHit* hit) {
+    if (ref & VOXEL_DAG_LEAF) {
+        uint16_t type = (uint16_t)ref;
+        if (type == CHUNK_VOXEL_AIR)
+            return false;
+
+        static const enum ChunkFace entered[3][2] = {
+            { CHUNK_FACE_NEG_X, CHUNK_FACE_POS_X },
+            { CHUNK_FACE_NEG_Y, CHUNK_FACE_POS_Y },
+            { CHUNK_FACE_NEG_Z, CHUNK_FACE_POS_Z },
+        };
+
+        uint32_t pos[3];
+        for (int k = 0; k < 3; ++k) {
+            float p = floorf(ray->origin[k] + ray->dir[k] * t);
+            if (k == axis)
+                p = ray->dir[k] > 0.0f ? lo[k] : lo[k] + side - 1.0f;
+            if (p < lo[k])
+                p = lo[k];
+            if (p > lo[k] + side - 1.0f)
+                p = lo[k] + side - 1.0f;
+            pos[k] = (uint32_t)p;
+        }
+
+        hit->pos = (struct Size3D){ pos[0], pos[1], pos[2] };
+        hit->type = type;
+        hit->t = t;
+        hit->face = axis < 0
+            ? CHUNK_FACE_COUNT : entered[axis][ray->dir[axis] < 0.0f];
+        return true;
+    }
+
+    struct {
+        float t;
+        int axis;
+        size_t i;
+    } order[8];
+    size_t count = 0;
+
+    float half = side / 2.0f;
+    for (size_t i = 0; i < 8; ++i) {
+        float child_lo[3] = {
+            lo[0] + (i & 1 ? half : 0.0f),
+            lo[1] + (i & 2 ? half : 0.0f),
+            lo[2] + (i & 4 ? half : 0.0f) };
+        float child_t;
+        int child_axis;
+        if (!fe__dag_ray_box(ray, child_lo, half, &child_t, &child_axis))
+            continue;
+
+        // a ray crosses at most 4 children, insertion sort is plenty
+        size_t at = count++;
+        for (; at > 0 && order[at - 1].t > child_t; --at)
+            order[at] = order[at - 1];
+        order[at].t = child_t;
+        order[at].axis = child_axis;
+        order[at].i = i;
+    }
+
+    for (size_t j = 0; j < count; ++j) {
+        size_t i = order[j].i;
+        float child_lo[3] = {
+            lo[0] + (i & 1 ? half : 0.0f),
+            lo[1] + (i & 2 ? half : 0.0f),
+            lo[2] + (i & 4 ? half : 0.0f) };
+        if (fe__dag_ray_node(dag, ray, dag->nodes[ref].children[i], child_lo,
+                             half, order[j].t, order[j].axis, hit))
+            return true;
+    }
+    return false;
+}
+
+bool VoxelDag_raycast(const struct VoxelDag* dag, const float origin[3],
+                      const float dir[3], float max_t,
+                      struct VoxelDagHit* hit) {
+    if (!hit) {
+        FE_WARNING("Warning: NULL hit passed to `VoxelDag_raycast`");
+        return false;
+    }
+
+    struct fe__dag_ray_t ray = { .max_t = max_t };
+    for (int k = 0; k < 3; ++k) {
+        ray.origin[k] = origin[k];
+        ray.dir[k] = dir[k];
+        ray.inv[k] = dir[k] != 0.0f ? 1.0f / dir[k] : 0.0f;
+    }
+
+    float lo[3] = { 0.0f, 0.0f, 0.0f };
+    float side = (float)VoxelDag_side(dag);
+    float t;
+    int axis;
+    if (!fe__dag_ray_box(&ray, lo, side, &t, &axis))
+        return false;
+    return fe__dag_ray_node(dag, &ray, dag->root, lo, side, t, axis, hit);
+}
+
+static size_t fe__dag_mark(const struct VoxelDag* dag, uint32_t ref,
+                           uint64_t* seen) {
+    if ((ref & VOXEL_DAG_LEAF) || (seen[ref / 64] >> (ref % 64) & 1))
+        return 0;
+
+    seen[ref / 64] |= 1ULL << (ref % 64);
+    size_t count = 1;
+    for (size_t i = 0; i < 8; ++i)
+        count += fe__dag_mark(dag, dag->nodes[ref].children[i], seen);
+    return count;
+}
+
+size_t VoxelDag_count_nodes(const struct VoxelDag* dag) {
+    if (dag->len == 0)
+        return 0;
+
+    uint64_t* seen = calloc((dag->len + 63) / 64, sizeof *seen);
+    if (!seen) {
+        FE_FATAL("Could not allocate %lu bytes for DAG traversal.",
+                 (dag->len + 63) / 64 * sizeof *seen);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    size_t count = fe__dag_mark(dag, dag->root, seen);
+    free(seen);
+    return count;
+}
+
+size_t VoxelDag_bytes(const struct VoxelDag* dag) {
+    return dag->cap * sizeof *dag->nodes
+        + dag->lookup_cap * sizeof *dag->lookup;
+}
+
+/**
+ * @brief Copies the subtree of `ref` into `nodes`, children first, and
+ * returns its new reference. `remap` holds the new index of every node
+ * copied so far, shared subtrees are copied once.
+ */
+static uint32_t fe__dag_copy(const struct VoxelDag* dag, uint32_t ref,
+                             uint32_t* remap, struct VoxelDagNode* nodes,
+                             size_t* len) {
+    if (ref & VOXEL_DAG_LEAF)
+        return ref;
+    if (remap[ref] != FE_DAG_NO_NODE)
+        return remap[ref];
+
+    struct VoxelDagNode node;
+    for (size_t i = 0; i < 8; ++i)
+        node.children[i] = fe__dag_copy(dag, dag->nodes[ref].children[i],
+                                        remap, nodes, len);
+
+    uint32_t index = (uint32_t)(*len)++;
+    nodes[index] = node;
+    remap[ref] = index;
+    return index;
+}
+
+void VoxelDag_compact(struct VoxelDag* dag) {
+    if (dag->len == 0)
+        return;
+
+    size_t live = VoxelDag_count_nodes(dag);
+    uint32_t* remap = malloc(dag->len * sizeof *remap);
+    struct VoxelDagNode* nodes = malloc((live ? live : 1) * sizeof *nodes);
+    if (!remap || !nodes) {
+        FE_FATAL("Could not allocate %lu bytes for DAG compaction.",
+                 dag->len * sizeof *remap + live * sizeof *nodes);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    memset(remap, 0xFF, dag->len * sizeof *remap);
+
+    size_t len = 0;
+    uint32_t root = fe__dag_copy(dag, dag->root, remap, nodes, &len);
+    free(remap);
+    free(dag->nodes);
+
+    dag->nodes = nodes;
+    dag->len = len;
+    dag->cap = live ? live : 1;
+    dag->root = root;
+
+    size_t cap = 128;
+    while (len + 1 > FE_DAG_MAX_LOAD(cap))
+        cap *= 2;
+    fe__dag_rehash(dag, cap);
+}
+
+void VoxelDag_destroy(struct VoxelDag* dag) {
+    if (!dag) {
+        FE_WARNING("Warning: NULL dag passed to `VoxelDag_destroy`");
+        return;
+    }
+
+    free(dag->nodes);
+    free(dag->lookup);
+    *dag = (struct VoxelDag){ .depth = dag->depth,
+                              .root = VOXEL_DAG_LEAF_REF(CHUNK_VOXEL_AIR) };
+}
@@ -1,26 +1,346 @@
 #include <fe/geometries/vchunk.h>
 #include <fe/logger.h>
 #include <fe/err.h>
+#include <fe/jobs.h>
+#include <fe/pool.h>
 
 #include <cglm/cglm.h>
 
+#include <stdbool.h>
 #include <string.h>
 
+// SSE2 is part of x86-64, AVX2 is detected at runtime 
+#if defined(__x86_64__)
+#define VC__X86 
+#include <immintrin.h>
+#endif
+
+// Voxel storage and vertex buffers come from a process wide pool, since 
+// streaming creates and destroys them constantly. 
+static struct BufferPool* vc__buffers;
+static bool vc__buffers_request; // set by `Chunk_init_buffers()`
+static bool vc__buffers_hugepages; // what the pool was created with
+static pthread_once_t vc__buffers_once = PTHREAD_ONCE_INIT;
+
+static void vc__buffers_create(void) {
+    vc__buffers_hugepages = vc__buffers_request;
+    vc__buffers = BufferPool__create(vc__buffers_hugepages);
+}
+
+struct BufferPool* Chunk_buffer_pool(void) {
+    pthread_once(&vc__buffers_once, vc__buffers_create);
+    return vc__buffers;
+}
+
+void Chunk_init_buffers(bool hugepages) {
+    vc__buffers_request = hugepages;
+    pthread_once(&vc__buffers_once, vc__buffers_create);
+    if (vc__buffers_hugepages != hugepages)
+        FE_WARNING("Chunk buffers were created before `Chunk_init_buffers`.");
+}
+
+static inline size_t vc__voxels_bytes(const struct Chunk* chunk) {
+    return (size_t)chunk->size.x * chunk->size.y * chunk->size.z 
+        * sizeof *chunk->voxels;
+}
+
+static inline size_t vc__bits_bytes(const struct Chunk* chunk) {
+    return chunk->row_words * chunk->size.y * chunk->size.z 
+        * sizeof *chunk->bits;
+}
+
+static inline size_t vc__runs_bytes(size_t len) {
+    return len * (sizeof (uint32_t) + sizeof (uint16_t));
+}
+
+/**
+ * @brief Returns the run of `runs` holding voxel `idx`.
+ */
+static inline size_t vc__runs_find(const struct ChunkRuns* runs, size_t idx) {
+    size_t lo = 0;
+    size_t hi = runs->len - 1;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (runs->ends[mid] <= idx)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief log2 of the edge length of `size` if it is one of 
+ * `CHUNK_FIXED_SIZES`, else 0.
+ */
+static uint8_t vc__fixed_size_log2(struct Size3D size) {
+    if (size.x != size.y || size.y != size.z)
+        return 0;
+
+    switch (size.x) {
+#define VC__FIXED_CASE(n, log2) case n: return log2;
+        CHUNK_FIXED_SIZES(VC__FIXED_CASE)
+#undef VC__FIXED_CASE
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Bits of word `word` of a row `width` voxels wide that hold a 
+ * voxel, i.e. every bit but those past the end of the row.
+ */
+static inline uint64_t vc__row_mask(size_t width, size_t word) {
+    size_t left = width - word * 64;
+    return left >= 64 ? ~0ULL : (1ULL << left) - 1;
+}
+
+struct Chunk Chunk__create_uniform(struct Size3D chunk_size, 
+                                   enum ChunkStorage storage, uint16_t type) {
+    struct Chunk chunk = {
+        .scale = 1.0, .size = chunk_size, .storage = storage,
+        .size_log2 = vc__fixed_size_log2(chunk_size),
+        .uniform = true, .uniform_type = type };
+    if (storage != CHUNK_STORAGE_PALETTE && type != CHUNK_VOXEL_AIR)
+        chunk.uniform_type = CHUNK_VOXEL_SOLID;
+    if (storage == CHUNK_STORAGE_BITS)
+        chunk.row_words = (chunk_size.x + 63) / 64;
+    return chunk;
+}
+
 struct Chunk Chunk__create(struct Size3D chunk_size) {
-    struct Chunk chunk = {.scale = 1.0, .size = chunk_size};
+    return Chunk__create_uniform(chunk_size, CHUNK_STORAGE_VOXELS, 
+                                 CHUNK_VOXEL_AIR);
+}
 
-    size_t allocsz = sizeof (struct Voxel)
-        * chunk.size.x
-        * chunk.size.y
-        * chunk.size.z;
-    chunk.voxels = calloc(chunk.size.x * chunk.size.y * chunk.size.z, sizeof (struct Voxel));
-    
-    if (!chunk.voxels) {
-        FE_FATAL("Could not allocate %lu bytes for voxel chunk.", allocsz); 
+struct Chunk Chunk__create_bits(struct Size3D chunk_size) {
+    return Chunk__create_uniform(chunk_size, CHUNK_STORAGE_BITS, 
+                                 CHUNK_VOXEL_AIR);
+}
+
+static void vc__palette_insert_lookup(struct ChunkPalette* palette, 
+                                      uint16_t type, uint32_t index) {
+    size_t mask = palette->lookup_cap - 1;
+    size_t slot = ((uint32_t)type * 2654435761u) & mask;
+    while (palette->lookup[slot])
+        slot = (slot + 1) & mask;
+    palette->lookup[slot] = index + 1;
+}
+
+/**
+ * @brief Sizes the lookup of `palette` to at least twice its capacity and
+ * reinserts every type.
+ */
+static void vc__palette_rehash(struct ChunkPalette* palette) {
+    size_t cap = 16;
+    while (cap < palette->cap * 2)
+        cap *= 2;
+
+    free(palette->lookup);
+    palette->lookup = calloc(cap, sizeof *palette->lookup);
+    if (!palette->lookup) {
+        FE_FATAL("Could not allocate %lu bytes for chunk palette.", 
+                 cap * sizeof *palette->lookup);
         exit(FE_ERR_BAD_ALLOC);
     }
+    palette->lookup_cap = cap;
 
-    return chunk;
+    for (size_t i = 0; i < palette->len; ++i)
+        vc__palette_insert_lookup(palette, palette->types[i], (uint32_t)i);
+}
+
+static size_t vc__palette_index_words(const struct ChunkPalette* palette,
+                                      size_t voxel_len) {
+    size_t per_word = 64 / palette->index_bits;
+    return (voxel_len + per_word - 1) / per_word;
+}
+
+static inline uint32_t vc__palette_get(const struct ChunkPalette* palette, 
+                                       size_t idx) {
+    uint32_t bits = palette->index_bits;
+    size_t per_word = 64 / bits;
+    uint64_t word = palette->indices[idx / per_word];
+    return (uint32_t)(word >> (idx % per_word * bits)) 
+        & (uint32_t)((1ULL << bits) - 1);
+}
+
+static inline void vc__palette_put(struct ChunkPalette* palette, 
+                                   size_t idx, uint32_t index) {
+    uint32_t bits = palette->index_bits;
+    size_t per_word = 64 / bits;
+    uint64_t* word = palette->indices + idx / per_word;
+    uint32_t shift = (uint32_t)(idx % per_word * bits);
+    uint64_t mask = ((1ULL << bits) - 1) << shift;
+    *word = (*word & ~mask) | ((uint64_t)index << shift);
+}
+
+/**
+ * @brief Repacks the indices of `palette` at twice their width.
+ */
+static void vc__palette_widen(struct ChunkPalette* palette, size_t voxel_len) {
+    struct ChunkPalette wide = *palette;
+    wide.index_bits = palette->index_bits * 2;
+    wide.indices = BufferPool_calloc(Chunk_buffer_pool(), 
+        vc__palette_index_words(&wide, voxel_len) * sizeof *wide.indices);
+
+    for (size_t i = 0; i < voxel_len; ++i)
+        vc__palette_put(&wide, i, vc__palette_get(palette, i));
+
+    BufferPool_free(Chunk_buffer_pool(), palette->indices, 
+        vc__palette_index_words(palette, voxel_len) * sizeof *palette->indices);
+    *palette = wide;
+}
+
+/**
+ * @brief Returns the palette index of `type`, adding it to the palette 
+ * (and widening the indices) if it is new.
+ */
+static uint32_t vc__palette_index_of(struct ChunkPalette* palette, 
+                                     uint16_t type, size_t voxel_len) {
+    size_t mask = palette->lookup_cap - 1;
+    for (size_t slot = ((uint32_t)type * 2654435761u) & mask; 
+         palette->lookup[slot]; slot = (slot + 1) & mask) {
+        uint32_t index = palette->lookup[slot] - 1;
+        if (palette->types[index] == type)
+            return index;
+    }
+
+    if (palette->len == palette->cap) {
+        size_t cap = palette->cap * 2;
+        uint16_t* types = realloc(palette->types, cap * sizeof *types);
+        if (!types) {
+            FE_FATAL("Could not allocate %lu bytes for chunk palette.", 
+                     cap * sizeof *types);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+        palette->types = types;
+        palette->cap = cap;
+        vc__palette_rehash(palette);
+    }
+
+    uint32_t index = (uint32_t)palette->len++;
+    palette->types[index] = type;
+    vc__palette_insert_lookup(palette, type, index);
+
+    if (palette->len > (1ULL << palette->index_bits))
+        vc__palette_widen(palette, voxel_len);
+
+    return index;
+}
+
+struct Chunk Chunk__create_palette(struct Size3D chunk_size) {
+    return Chunk__create_uniform(chunk_size, CHUNK_STORAGE_PALETTE, 
+                                 CHUNK_VOXEL_AIR);
+}
+
+/**
+ * @brief Gives uniform `chunk` storage of its own, filled with its type, 
+ * before one of its voxels is set to another type.
+ */
+static void vc__chunk_promote(struct Chunk* chunk) {
+    struct BufferPool* buffers = Chunk_buffer_pool();
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    uint16_t type = chunk->uniform_type;
+    chunk->uniform = false;
+
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        struct ChunkPalette* palette = &chunk->palette;
+        palette->cap = 2;
+        palette->types = calloc(palette->cap, sizeof *palette->types);
+        palette->index_bits = 1;
+        size_t words = vc__palette_index_words(palette, voxel_len);
+        palette->indices = BufferPool_calloc(buffers, 
+                                             words * sizeof *palette->indices);
+
+        if (!palette->types) {
+            FE_FATAL("Could not allocate %lu bytes for voxel chunk.", 
+                     palette->cap * sizeof *palette->types); 
+            exit(FE_ERR_BAD_ALLOC);
+        }
+
+        palette->types[palette->len++] = CHUNK_VOXEL_AIR;
+        vc__palette_rehash(palette);
+        if (type == CHUNK_VOXEL_AIR)
+            return;
+
+        // the type lands on index 1 of the 1-bit indices, so every index 
+        // bit of the chunk is set, as if it were a single row of voxels 
+        vc__palette_index_of(palette, type, voxel_len);
+        for (size_t i = 0; i < words; ++i)
+            palette->indices[i] = vc__row_mask(voxel_len, i);
+        return;
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        chunk->bits = BufferPool_calloc(buffers, vc__bits_bytes(chunk));
+        if (type == CHUNK_VOXEL_AIR)
+            return;
+
+        size_t rows = (size_t)chunk->size.y * chunk->size.z;
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t k = 0; k < chunk->row_words; ++k)
+                chunk->bits[row * chunk->row_words + k] 
+                    = vc__row_mask(chunk->size.x, k);
+        }
+        return;
+    }
+
+    chunk->voxels = BufferPool_calloc(buffers, vc__voxels_bytes(chunk));
+    if (type == CHUNK_VOXEL_AIR)
+        return;
+    for (size_t i = 0; i < voxel_len; ++i)
+        chunk->voxels[i].enabled = 1;
+}
+
+struct Chunk Chunk__copy(const struct Chunk* chunk) {
+    // uniform chunks own no storage 
+    if (chunk->uniform)
+        return *chunk;
+
+    struct BufferPool* buffers = Chunk_buffer_pool();
+    struct Chunk copy = *chunk;
+    if (chunk->compressed) {
+        size_t bytes = vc__runs_bytes(chunk->runs.len);
+        copy.runs.ends = BufferPool_alloc(buffers, bytes);
+        copy.runs.values = (uint16_t*)(copy.runs.ends + chunk->runs.len);
+        memcpy(copy.runs.ends, chunk->runs.ends, bytes);
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        const struct ChunkPalette* palette = &chunk->palette;
+        copy.palette.types = malloc(palette->cap * sizeof *palette->types);
+        copy.palette.lookup = malloc(palette->lookup_cap 
+                                     * sizeof *palette->lookup);
+        if (!copy.palette.types || !copy.palette.lookup) {
+            FE_FATAL("Could not allocate %lu bytes for voxel chunk.", 
+                     palette->cap * sizeof *palette->types 
+                     + palette->lookup_cap * sizeof *palette->lookup); 
+            exit(FE_ERR_BAD_ALLOC);
+        }
+
+        memcpy(copy.palette.types, palette->types, 
+               palette->len * sizeof *palette->types);
+        memcpy(copy.palette.lookup, palette->lookup, 
+               palette->lookup_cap * sizeof *palette->lookup);
+        if (!chunk->compressed) {
+            size_t bytes = Chunk_storage_bytes(chunk);
+            copy.palette.indices = BufferPool_alloc(buffers, bytes);
+            memcpy(copy.palette.indices, palette->indices, bytes);
+        }
+        return copy;
+    }
+
+    if (chunk->compressed)
+        return copy;
+
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        copy.bits = BufferPool_alloc(buffers, vc__bits_bytes(chunk));
+        memcpy(copy.bits, chunk->bits, vc__bits_bytes(chunk));
+        return copy;
+    }
+
+    copy.voxels = BufferPool_alloc(buffers, vc__voxels_bytes(chunk));
+    memcpy(copy.voxels, chunk->voxels, vc__voxels_bytes(chunk));
+    return copy;
 }
 
 void Chunk_destroy(struct Chunk* chunk) {
@@ -31,10 +351,93 @@ void Chunk_destroy(struct Chunk* chunk) {
         return;
     }
 
-    free(chunk->voxels); 
+    struct BufferPool* buffers = Chunk_buffer_pool();
+    BufferPool_free(buffers, chunk->voxels, vc__voxels_bytes(chunk)); 
+    BufferPool_free(buffers, chunk->bits, vc__bits_bytes(chunk));
+    BufferPool_free(buffers, chunk->runs.ends, vc__runs_bytes(chunk->runs.len));
+    free(chunk->palette.types);
+    free(chunk->palette.lookup);
+    if (chunk->palette.indices) {
+        size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+        BufferPool_free(buffers, chunk->palette.indices, 
+            vc__palette_index_words(&chunk->palette, voxel_len) 
+            * sizeof *chunk->palette.indices);
+    }
+}
+
+// Morton codes interleave the bits of x, y and z (x lowest), so voxels 
+// close in space are close in memory along every axis. With BMI2 the 
+// (de)interleaving is a single pdep/pext per axis; otherwise it is done 
+// with the usual shift-and-mask "magic bits". Coordinates are 21 bits.
+#define VC__MORTON_X 0x1249249249249249ULL
+#define VC__MORTON_Y (VC__MORTON_X << 1)
+#define VC__MORTON_Z (VC__MORTON_X << 2)
+
+#ifdef __BMI2__
+static inline uint64_t vc__morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+    return _pdep_u64(x, VC__MORTON_X) | _pdep_u64(y, VC__MORTON_Y) 
+        | _pdep_u64(z, VC__MORTON_Z);
+}
+
+static inline struct Size3D vc__morton_decode(uint64_t code) {
+    return (struct Size3D){ 
+        (uint32_t)_pext_u64(code, VC__MORTON_X), 
+        (uint32_t)_pext_u64(code, VC__MORTON_Y), 
+        (uint32_t)_pext_u64(code, VC__MORTON_Z) };
+}
+#else 
+static inline uint64_t vc__morton_split(uint32_t v) {
+    uint64_t x = v & 0x1FFFFF;
+    x = (x | x << 32) & 0x1F00000000FFFFULL;
+    x = (x | x << 16) & 0x1F0000FF0000FFULL;
+    x = (x | x << 8) & 0x100F00F00F00F00FULL;
+    x = (x | x << 4) & 0x10C30C30C30C30C3ULL;
+    x = (x | x << 2) & VC__MORTON_X;
+    return x;
+}
+
+static inline uint32_t vc__morton_compact(uint64_t x) {
+    x &= VC__MORTON_X;
+    x = (x ^ (x >> 2)) & 0x10C30C30C30C30C3ULL;
+    x = (x ^ (x >> 4)) & 0x100F00F00F00F00FULL;
+    x = (x ^ (x >> 8)) & 0x1F0000FF0000FFULL;
+    x = (x ^ (x >> 16)) & 0x1F00000000FFFFULL;
+    x = (x ^ (x >> 32)) & 0x1FFFFF;
+    return (uint32_t)x;
+}
+
+static inline uint64_t vc__morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+    return vc__morton_split(x) | vc__morton_split(y) << 1 
+        | vc__morton_split(z) << 2;
+}
+
+static inline struct Size3D vc__morton_decode(uint64_t code) {
+    return (struct Size3D){ 
+        vc__morton_compact(code), 
+        vc__morton_compact(code >> 1), 
+        vc__morton_compact(code >> 2) };
+}
+#endif
+
+uint64_t Chunk_morton_encode(struct Size3D pos) {
+    return vc__morton_encode(pos.x, pos.y, pos.z);
+}
+
+struct Size3D Chunk_morton_decode(uint64_t code) {
+    return vc__morton_decode(code);
 }
 
 struct Size3D Chunk_get_iaspos(struct Chunk* chunk, size_t idx) {
+    if (chunk->layout == CHUNK_LAYOUT_MORTON)
+        return vc__morton_decode(idx);
+
+    switch (chunk->size_log2) {
+#define VC__FIXED_CASE(n, log2) case log2: return Chunk##n##_get_iaspos(idx);
+        CHUNK_FIXED_SIZES(VC__FIXED_CASE)
+#undef VC__FIXED_CASE
+        default: break;
+    }
+
     struct Size3D size = chunk->size;
     
     uint32_t ix = (uint32_t)((idx % (size.x * size.y)) % size.x);
@@ -44,6 +447,511 @@ struct Size3D Chunk_get_iaspos(struct Chunk* chunk, size_t idx) {
     return (struct Size3D){ ix, iy, iz };
 }
 
+static inline size_t vc__chunk_row_of(const struct Chunk* chunk, 
+                                      uint32_t y, uint32_t z) {
+    return (size_t)z * chunk->size.y + y;
+}
+
+/**
+ * @brief Storage index of the voxel at (x, y, z) in the layout of `chunk`.
+ */
+static inline size_t vc__chunk_index(const struct Chunk* chunk, 
+                                     uint32_t x, uint32_t y, uint32_t z) {
+    if (chunk->layout == CHUNK_LAYOUT_MORTON)
+        return (size_t)vc__morton_encode(x, y, z);
+
+    switch (chunk->size_log2) {
+#define VC__FIXED_CASE(n, log2) case log2: return Chunk##n##_index(x, y, z);
+        CHUNK_FIXED_SIZES(VC__FIXED_CASE)
+#undef VC__FIXED_CASE
+        default: break;
+    }
+    return vc__chunk_row_of(chunk, y, z) * chunk->size.x + x;
+}
+
+size_t Chunk_index(const struct Chunk* chunk, struct Size3D pos) {
+    return vc__chunk_index(chunk, pos.x, pos.y, pos.z);
+}
+
+bool Chunk_set_layout(struct Chunk* chunk, enum ChunkLayout layout) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `Chunk_set_layout`");
+        return false;
+    }
+    if (chunk->layout == layout)
+        return true;
+
+    // Morton codes only cover the volume exactly for power of two cubes, 
+    // and bit chunk rows are the occupancy layout the mesher reads 
+    struct Size3D size = chunk->size;
+    if (layout == CHUNK_LAYOUT_MORTON 
+        && (chunk->storage == CHUNK_STORAGE_BITS 
+            || size.x != size.y || size.y != size.z 
+            || (size.x & (size.x - 1)) != 0)) {
+        FE_WARNING("Warning: Morton layout needs a power of two cube "
+                   "voxel or palette chunk, keeping linear layout.");
+        return false;
+    }
+
+    // runs follow the storage order, so they are not reordered in place 
+    Chunk_decompress(chunk);
+
+    size_t voxel_len = (size_t)size.x * size.y * size.z;
+    struct Chunk from = *chunk;
+    chunk->layout = layout;
+    if (chunk->uniform)
+        return true;
+
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        size_t bytes = vc__palette_index_words(&chunk->palette, voxel_len) 
+            * sizeof *chunk->palette.indices;
+        chunk->palette.indices = BufferPool_calloc(Chunk_buffer_pool(), bytes);
+
+        for (uint32_t z = 0; z < size.z; ++z)
+        for (uint32_t y = 0; y < size.y; ++y)
+        for (uint32_t x = 0; x < size.x; ++x) {
+            vc__palette_put(&chunk->palette, vc__chunk_index(chunk, x, y, z), 
+                vc__palette_get(&from.palette, 
+                                vc__chunk_index(&from, x, y, z)));
+        }
+        BufferPool_free(Chunk_buffer_pool(), from.palette.indices, bytes);
+        return true;
+    }
+
+    chunk->voxels = BufferPool_alloc(Chunk_buffer_pool(), 
+                                     vc__voxels_bytes(chunk));
+
+    for (uint32_t z = 0; z < size.z; ++z)
+    for (uint32_t y = 0; y < size.y; ++y)
+    for (uint32_t x = 0; x < size.x; ++x) {
+        chunk->voxels[vc__chunk_index(chunk, x, y, z)] 
+            = from.voxels[vc__chunk_index(&from, x, y, z)];
+    }
+    BufferPool_free(Chunk_buffer_pool(), from.voxels, vc__voxels_bytes(&from));
+    return true;
+}
+
+/**
+ * @brief Whether voxel `idx` (as from `vc__chunk_index()`) is enabled, 
+ * in any storage.
+ */
+static inline bool vc__chunk_enabled_index(const struct Chunk* chunk, 
+                                           size_t idx) {
+    if (chunk->uniform)
+        return chunk->uniform_type != CHUNK_VOXEL_AIR;
+    // palette index 0 is always air 
+    if (chunk->compressed)
+        return chunk->runs.values[vc__runs_find(&chunk->runs, idx)] != 0;
+    if (chunk->storage == CHUNK_STORAGE_PALETTE)
+        return vc__palette_get(&chunk->palette, idx) != 0;
+    if (chunk->storage == CHUNK_STORAGE_BITS && chunk->size_log2) {
+        // fixed sizes are at most 64 wide, so a row is a single word 
+        return (chunk->bits[idx >> chunk->size_log2] 
+                >> (idx & (chunk->size.x - 1))) & 1;
+    }
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        size_t row = idx / chunk->size.x;
+        size_t x = idx % chunk->size.x;
+        return (chunk->bits[row * chunk->row_words + x / 64] >> (x % 64)) & 1;
+    }
+    return chunk->voxels[idx].enabled;
+}
+
+static inline bool vc__chunk_enabled(const struct Chunk* chunk, 
+                                     uint32_t x, uint32_t y, uint32_t z) {
+    if (chunk->uniform)
+        return chunk->uniform_type != CHUNK_VOXEL_AIR;
+    if (chunk->storage == CHUNK_STORAGE_BITS && !chunk->compressed) {
+        return (chunk->bits[vc__chunk_row_of(chunk, y, z) * chunk->row_words 
+                            + x / 64] >> (x % 64)) & 1;
+    }
+    return vc__chunk_enabled_index(chunk, vc__chunk_index(chunk, x, y, z));
+}
+
+static inline uint16_t vc__chunk_type(const struct Chunk* chunk, 
+                                      uint32_t x, uint32_t y, uint32_t z) {
+    if (chunk->uniform)
+        return chunk->uniform_type;
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        size_t idx = vc__chunk_index(chunk, x, y, z);
+        uint32_t index = chunk->compressed 
+            ? chunk->runs.values[vc__runs_find(&chunk->runs, idx)]
+            : vc__palette_get(&chunk->palette, idx);
+        return chunk->palette.types[index];
+    }
+    return vc__chunk_enabled(chunk, x, y, z) 
+        ? CHUNK_VOXEL_SOLID : CHUNK_VOXEL_AIR;
+}
+
+static void vc__chunk_set_type(struct Chunk* chunk, struct Size3D pos, 
+                               uint16_t type);
+
+static inline void vc__chunk_set_enabled(struct Chunk* chunk, 
+                                         struct Size3D pos, bool enabled) {
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        vc__chunk_set_type(chunk, pos, 
+                           enabled ? CHUNK_VOXEL_SOLID : CHUNK_VOXEL_AIR);
+        return;
+    }
+    if (chunk->uniform) {
+        if (enabled == (chunk->uniform_type != CHUNK_VOXEL_AIR))
+            return;
+        vc__chunk_promote(chunk);
+    }
+    if (chunk->compressed) {
+        if (enabled == vc__chunk_enabled(chunk, pos.x, pos.y, pos.z))
+            return;
+        Chunk_decompress(chunk);
+    }
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        size_t row = vc__chunk_row_of(chunk, pos.y, pos.z);
+        uint64_t* word = chunk->bits + row * chunk->row_words + pos.x / 64;
+        uint64_t bit = 1ULL << (pos.x % 64);
+        *word = enabled ? *word | bit : *word & ~bit;
+        return;
+    }
+    chunk->voxels[vc__chunk_index(chunk, pos.x, pos.y, pos.z)].enabled = enabled;
+}
+
+static void vc__chunk_set_type(struct Chunk* chunk, struct Size3D pos, 
+                               uint16_t type) {
+    if (chunk->storage != CHUNK_STORAGE_PALETTE) {
+        vc__chunk_set_enabled(chunk, pos, type != CHUNK_VOXEL_AIR);
+        return;
+    }
+    if (chunk->uniform) {
+        if (type == chunk->uniform_type)
+            return;
+        vc__chunk_promote(chunk);
+    }
+    if (chunk->compressed) {
+        if (type == vc__chunk_type(chunk, pos.x, pos.y, pos.z))
+            return;
+        Chunk_decompress(chunk);
+    }
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    size_t idx = vc__chunk_index(chunk, pos.x, pos.y, pos.z);
+    uint32_t index = vc__palette_index_of(&chunk->palette, type, voxel_len);
+    vc__palette_put(&chunk->palette, idx, index);
+}
+
+uint16_t Chunk_get_type(const struct Chunk* chunk, struct Size3D pos) {
+    return vc__chunk_type(chunk, pos.x, pos.y, pos.z);
+}
+
+void Chunk_set_type(struct Chunk* chunk, struct Size3D pos, uint16_t type) {
+    vc__chunk_set_type(chunk, pos, type);
+}
+
+bool Chunk_is_set(const struct Chunk* chunk, struct Size3D pos) {
+    return vc__chunk_enabled(chunk, pos.x, pos.y, pos.z);
+}
+
+void Chunk_set(struct Chunk* chunk, struct Size3D pos) {
+    vc__chunk_set_enabled(chunk, pos, true);
+}
+
+void Chunk_clear(struct Chunk* chunk, struct Size3D pos) {
+    vc__chunk_set_enabled(chunk, pos, false);
+}
+
+/**
+ * @brief Replaces `chunk` with a uniform chunk of `type`, freeing its 
+ * storage.
+ */
+static void vc__chunk_make_uniform(struct Chunk* chunk, uint16_t type) {
+    struct Chunk uniform = Chunk__create_uniform(chunk->size, chunk->storage, 
+                                                 type);
+    uniform.scale = chunk->scale;
+    uniform.layout = chunk->layout;
+    Chunk_destroy(chunk);
+    *chunk = uniform;
+}
+
+bool Chunk_collapse(struct Chunk* chunk) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `Chunk_collapse`");
+        return false;
+    }
+    if (chunk->uniform)
+        return true;
+    // runs are merged, so compressed chunks hold more than one type 
+    if (chunk->compressed)
+        return false;
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    uint16_t type;
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        // any order will do, so the indices are scanned as stored 
+        uint32_t first = vc__palette_get(&chunk->palette, 0);
+        for (size_t i = 1; i < voxel_len; ++i) {
+            if (vc__palette_get(&chunk->palette, i) != first)
+                return false;
+        }
+        type = chunk->palette.types[first];
+    } else {
+        size_t enabled = Chunk_count_enabled(chunk);
+        if (enabled != 0 && enabled != voxel_len)
+            return false;
+        type = enabled ? CHUNK_VOXEL_SOLID : CHUNK_VOXEL_AIR;
+    }
+
+    vc__chunk_make_uniform(chunk, type);
+    return true;
+}
+
+/**
+ * @brief The value a compressed `chunk` stores in a run for voxel `idx`.
+ */
+static inline uint16_t vc__chunk_run_value(const struct Chunk* chunk, 
+                                           size_t idx) {
+    if (chunk->storage == CHUNK_STORAGE_PALETTE)
+        return (uint16_t)vc__palette_get(&chunk->palette, idx);
+    return vc__chunk_enabled_index(chunk, idx);
+}
+
+bool Chunk_compress(struct Chunk* chunk) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `Chunk_compress`");
+        return false;
+    }
+    if (chunk->uniform || chunk->compressed)
+        return chunk->compressed;
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    size_t len = 1;
+    uint16_t value = vc__chunk_run_value(chunk, 0);
+    for (size_t i = 1; i < voxel_len; ++i) {
+        uint16_t next = vc__chunk_run_value(chunk, i);
+        len += next != value;
+        value = next;
+    }
+
+    if (len == 1) {
+        vc__chunk_make_uniform(chunk, chunk->storage == CHUNK_STORAGE_PALETTE 
+            ? chunk->palette.types[value] 
+            : value ? CHUNK_VOXEL_SOLID : CHUNK_VOXEL_AIR);
+        return false;
+    }
+    if (vc__runs_bytes(len) >= Chunk_storage_bytes(chunk))
+        return false;
+
+    struct BufferPool* buffers = Chunk_buffer_pool();
+    struct ChunkRuns runs = { .len = len };
+    runs.ends = BufferPool_alloc(buffers, vc__runs_bytes(len));
+    runs.values = (uint16_t*)(runs.ends + len);
+
+    size_t run = 0;
+    runs.values[0] = vc__chunk_run_value(chunk, 0);
+    for (size_t i = 1; i < voxel_len; ++i) {
+        uint16_t next = vc__chunk_run_value(chunk, i);
+        if (next == runs.values[run])
+            continue;
+        runs.ends[run++] = (uint32_t)i;
+        runs.values[run] = next;
+    }
+    runs.ends[run] = (uint32_t)voxel_len;
+
+    BufferPool_free(buffers, chunk->voxels, vc__voxels_bytes(chunk)); 
+    BufferPool_free(buffers, chunk->bits, vc__bits_bytes(chunk));
+    if (chunk->palette.indices) {
+        BufferPool_free(buffers, chunk->palette.indices, 
+            vc__palette_index_words(&chunk->palette, voxel_len) 
+            * sizeof *chunk->palette.indices);
+    }
+    chunk->voxels = NULL;
+    chunk->bits = NULL;
+    chunk->palette.indices = NULL;
+
+    chunk->compressed = true;
+    chunk->runs = runs;
+    return true;
+}
+
+void Chunk_decompress(struct Chunk* chunk) {
+    if (!chunk) {
+        FE_WARNING("Warning: NULL chunk passed to `Chunk_decompress`");
+        return;
+    }
+    if (!chunk->compressed)
+        return;
+
+    struct BufferPool* buffers = Chunk_buffer_pool();
+    struct ChunkRuns runs = chunk->runs;
+    chunk->compressed = false;
+    chunk->runs = (struct ChunkRuns){ 0 };
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        chunk->palette.indices = BufferPool_calloc(buffers, 
+            vc__palette_index_words(&chunk->palette, voxel_len) 
+            * sizeof *chunk->palette.indices);
+    } else if (chunk->storage == CHUNK_STORAGE_BITS) {
+        chunk->bits = BufferPool_calloc(buffers, vc__bits_bytes(chunk));
+    } else {
+        chunk->voxels = BufferPool_calloc(buffers, vc__voxels_bytes(chunk));
+    }
+
+    // storage starts out as air, so only the other runs are written 
+    size_t from = 0;
+    for (size_t run = 0; run < runs.len; from = runs.ends[run++]) {
+        uint16_t value = runs.values[run];
+        if (value == 0)
+            continue;
+
+        for (size_t i = from; i < runs.ends[run]; ++i) {
+            if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+                vc__palette_put(&chunk->palette, i, value);
+            } else if (chunk->storage == CHUNK_STORAGE_BITS) {
+                size_t x = i % chunk->size.x;
+                chunk->bits[i / chunk->size.x * chunk->row_words + x / 64] 
+                    |= 1ULL << (x % 64);
+            } else {
+                chunk->voxels[i].enabled = 1;
+            }
+        }
+    }
+
+    BufferPool_free(buffers, runs.ends, vc__runs_bytes(runs.len));
+}
+
+size_t Chunk_storage_bytes(const struct Chunk* chunk) {
+    if (chunk->uniform)
+        return 0;
+    if (chunk->compressed)
+        return vc__runs_bytes(chunk->runs.len);
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        return vc__palette_index_words(&chunk->palette, 
+            (size_t)chunk->size.x * chunk->size.y * chunk->size.z) 
+            * sizeof *chunk->palette.indices;
+    }
+    if (chunk->storage == CHUNK_STORAGE_BITS)
+        return vc__bits_bytes(chunk);
+    return vc__voxels_bytes(chunk);
+}
+
+void Chunk_set_run(struct Chunk* chunk, size_t idx, size_t len, uint16_t type) {
+    if (len == 0)
+        return;
+    if (chunk->storage != CHUNK_STORAGE_PALETTE && type != CHUNK_VOXEL_AIR)
+        type = CHUNK_VOXEL_SOLID;
+    if (chunk->uniform) {
+        if (type == chunk->uniform_type)
+            return;
+        vc__chunk_promote(chunk);
+    }
+    Chunk_decompress(chunk);
+
+    size_t end = idx + len;
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+        uint32_t index = vc__palette_index_of(&chunk->palette, type, voxel_len);
+        for (size_t i = idx; i < end; ++i)
+            vc__palette_put(&chunk->palette, i, index);
+        return;
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        for (size_t i = idx; i < end; ++i) {
+            size_t x = i % chunk->size.x;
+            uint64_t* word = chunk->bits 
+                + i / chunk->size.x * chunk->row_words + x / 64;
+            uint64_t bit = 1ULL << (x % 64);
+            *word = type != CHUNK_VOXEL_AIR ? *word | bit : *word & ~bit;
+        }
+        return;
+    }
+
+    for (size_t i = idx; i < end; ++i)
+        chunk->voxels[i].enabled = type != CHUNK_VOXEL_AIR;
+}
+
+size_t Chunk_count_enabled(const struct Chunk* chunk) {
+    if (chunk->uniform) {
+        return chunk->uniform_type == CHUNK_VOXEL_AIR 
+            ? 0 : (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    }
+
+    size_t count = 0;
+    if (chunk->compressed) {
+        size_t from = 0;
+        for (size_t run = 0; run < chunk->runs.len; ++run) {
+            if (chunk->runs.values[run])
+                count += chunk->runs.ends[run] - from;
+            from = chunk->runs.ends[run];
+        }
+        return count;
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_PALETTE) {
+        // fold every index onto its lowest bit, which is then set for 
+        // every non-air voxel 
+        uint32_t bits = chunk->palette.index_bits;
+        uint64_t low = 0;
+        for (uint32_t i = 0; i < 64; i += bits)
+            low |= 1ULL << i;
+
+        size_t words = vc__palette_index_words(&chunk->palette,
+            (size_t)chunk->size.x * chunk->size.y * chunk->size.z);
+        for (size_t i = 0; i < words; ++i) {
+            uint64_t word = chunk->palette.indices[i];
+            for (uint32_t shift = 1; shift < bits; shift *= 2)
+                word |= word >> shift;
+            count += (size_t)__builtin_popcountll(word & low);
+        }
+        return count;
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_BITS) {
+        size_t words = chunk->row_words * chunk->size.y * chunk->size.z;
+        for (size_t i = 0; i < words; ++i)
+            count += (size_t)__builtin_popcountll(chunk->bits[i]);
+        return count;
+    }
+
+    size_t voxel_len = (size_t)chunk->size.x * chunk->size.y * chunk->size.z;
+    for (size_t i = 0; i < voxel_len; ++i)
+        count += chunk->voxels[i].enabled;
+    return count;
+}
+
+uint64_t Chunk_row(const struct Chunk* chunk, uint32_t y, uint32_t z, 
+                   size_t word) {
+    if (chunk->uniform) {
+        return chunk->uniform_type == CHUNK_VOXEL_AIR 
+            ? 0 : vc__row_mask(chunk->size.x, word);
+    }
+
+    size_t row = vc__chunk_row_of(chunk, y, z);
+    if (chunk->storage == CHUNK_STORAGE_BITS && !chunk->compressed)
+        return chunk->bits[row * chunk->row_words + word];
+
+    uint32_t x0 = (uint32_t)(word * 64);
+    uint32_t x1 = chunk->size.x - x0 < 64 ? chunk->size.x : x0 + 64;
+    uint64_t bits = 0;
+    for (uint32_t x = x0; x < x1; ++x)
+        bits |= (uint64_t)vc__chunk_enabled(chunk, x, y, z) << (x - x0);
+    return bits;
+}
+
+size_t Chunk_row_count(const struct Chunk* chunk, uint32_t y, uint32_t z) {
+    size_t words = (chunk->size.x + 63) / 64;
+    size_t count = 0;
+    for (size_t k = 0; k < words; ++k)
+        count += (size_t)__builtin_popcountll(Chunk_row(chunk, y, z, k));
+    return count;
+}
+
+uint64_t Chunk_column(const struct Chunk* chunk, uint32_t x, uint32_t z, 
+                      uint32_t y0) {
+    uint32_t y1 = chunk->size.y - y0 < 64 ? chunk->size.y : y0 + 64;
+    uint64_t bits = 0;
+    for (uint32_t y = y0; y < y1; ++y)
+        bits |= (uint64_t)vc__chunk_enabled(chunk, x, y, z) << (y - y0);
+    return bits;
+}
+
 // Verts per voxel = verts per side * 6 
 // verts pre side = verts per polygon * polygons per side 
 // verts per polygon = 3 
@@ -115,94 +1023,1622 @@ static struct vc__mesh_vertex vc_vverts[] = {
 
 #define VC__MV_ELEMS (sizeof vc_vverts / sizeof (struct vc__mesh_vertex))
 
-// TODO: Make way to pass relational chunks/faces to perform culling of 
-// outwardly-facing but still-hidden faces. Future concern.
-struct vc__float_verts_t vc__create_verts_dumb_naive(
-        struct Chunk* chunk) {
-    struct vc__float_verts_t verts;
+/**
+ * @brief Creates an empty vertex buffer with room for at least `cap` 
+ * floats, rounded up to the block it gets from the buffer pool.
+ */
+static struct vc__float_verts_t vc__float_verts_create(size_t cap) {
+    struct vc__float_verts_t verts = { 0 };
+    if (cap == 0)
+        return verts;
 
-    verts.cap = chunk->size.x * chunk->size.y * chunk->size.z * VERTS_PER_VOXEL;
-    verts.len = 0ULL;
-    verts.data = calloc(verts.cap, sizeof *verts.data);
+    size_t bytes = BufferPool_usable(cap * sizeof *verts.data);
+    verts.data = BufferPool_alloc(Chunk_buffer_pool(), bytes);
+    verts.cap = bytes / sizeof *verts.data;
+    return verts;
+}
 
-    float scale = (float)chunk->scale;
+static struct vc__float_verts_t vc__create_verts_naive_faces(
+        struct Chunk* chunk, size_t enabled, struct ChunkMeshOptions options);
 
-    if (!verts.data) {
-        FE_FATAL("Failed to allocate %ld bytes for vertices. Exiting.", 
-                 verts.len * sizeof (float));
-        exit(FE_ERR_BAD_ALLOC);
+/**
+ * Writes the whole voxel template translated to (x, y, z) and scaled, 
+ * i.e. `(template + pos) * scale`, straight to `dst`. Every kernel does 
+ * the same two float operations per scalar, so they all produce the 
+ * same bits.
+ */
+typedef void (*vc__emit_voxel_fn)(float* dst, float x, float y, float z, 
+                                  float scale);
+
+static void vc__emit_voxel_scalar(float* dst, float x, float y, float z, 
+                                  float scale) {
+    const struct vc__mesh_vertex* src = vc_vverts;
+    for (size_t i = 0; i < VC__MV_ELEMS; ++i) {
+        *dst++ = (src[i].x + x) * scale;
+        *dst++ = (src[i].y + y) * scale;
+        *dst++ = (src[i].z + z) * scale;
     }
-    FE_DEBUG("%ld bytes allocated for chunk.", verts.cap * sizeof *verts.data); 
+}
 
-    // this is probably an awful way to index. i havent decided how to do the 
-    // mapping. I hope this is correct though ..
-    size_t voxel_len = chunk->size.x * chunk->size.y * chunk->size.z;
-    for (size_t i = 0; i < voxel_len; ++i) {
-        if (!chunk->voxels[i].enabled)
-            continue;
+#ifdef VC__X86
+// The template is a flat run of xyz triples, so the translation repeats
+// every 3 floats: 3 registers of 4 lanes (or of 8) cover one period of 
+// 12 (or 24) floats. The template is packed, hence only unaligned loads
+// through a plain pointer.
+static inline __m128 vc__load4(const void* src, size_t i) {
+    return _mm_loadu_ps((const float*)src + i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256 vc__load8(const void* src, size_t i) {
+    return _mm256_loadu_ps((const float*)src + i);
+}
+
+static void vc__emit_voxel_sse(float* dst, float x, float y, float z, 
+                               float scale) {
+    const void* src = vc_vverts;
+    const __m128 off0 = _mm_setr_ps(x, y, z, x);
+    const __m128 off1 = _mm_setr_ps(y, z, x, y);
+    const __m128 off2 = _mm_setr_ps(z, x, y, z);
+    const __m128 s = _mm_set1_ps(scale);
+
+    for (size_t i = 0; i < VERTS_PER_VOXEL; i += 12) {
+        _mm_storeu_ps(dst + i, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i), off0), s));
+        _mm_storeu_ps(dst + i + 4, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i + 4), off1), s));
+        _mm_storeu_ps(dst + i + 8, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i + 8), off2), s));
+    }
+}
+
+__attribute__((target("avx2")))
+static void vc__emit_voxel_avx2(float* dst, float x, float y, float z, 
+                                float scale) {
+    const void* src = vc_vverts;
+    const __m256 off0 = _mm256_setr_ps(x, y, z, x, y, z, x, y);
+    const __m256 off1 = _mm256_setr_ps(z, x, y, z, x, y, z, x);
+    const __m256 off2 = _mm256_setr_ps(y, z, x, y, z, x, y, z);
+    const __m256 s = _mm256_set1_ps(scale);
+
+    size_t i = 0;
+    for (; i + 24 <= VERTS_PER_VOXEL; i += 24) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(
+            _mm256_add_ps(vc__load8(src, i), off0), s));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(
+            _mm256_add_ps(vc__load8(src, i + 8), off1), s));
+        _mm256_storeu_ps(dst + i + 16, _mm256_mul_ps(
+            _mm256_add_ps(vc__load8(src, i + 16), off2), s));
+    }
+
+    // 108 floats leave half a period, which starts at x again 
+    const __m128 tail0 = _mm256_castps256_ps128(off0);
+    const __m128 tail1 = _mm256_extractf128_ps(off0, 1);
+    const __m128 tail2 = _mm256_castps256_ps128(off1);
+    const __m128 s4 = _mm256_castps256_ps128(s);
+    for (; i < VERTS_PER_VOXEL; i += 12) {
+        _mm_storeu_ps(dst + i, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i), tail0), s4));
+        _mm_storeu_ps(dst + i + 4, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i + 4), tail1), s4));
+        _mm_storeu_ps(dst + i + 8, 
+                      _mm_mul_ps(_mm_add_ps(vc__load4(src, i + 8), tail2), s4));
+    }
+}
+#endif
+
+/**
+ * @brief Picks the widest voxel emission kernel the running CPU supports.
+ */
+static vc__emit_voxel_fn vc__emit_voxel_kernel(void) {
+#ifdef VC__X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return vc__emit_voxel_avx2;
+    if (__builtin_cpu_supports("sse"))
+        return vc__emit_voxel_sse;
+#endif
+    return vc__emit_voxel_scalar;
+}
+
+// Emits every face of every enabled voxel. Culling of hidden faces, 
+// including those hidden by neighboring chunks, is done by the culled 
+// and greedy meshers.
+struct vc__float_verts_t vc__create_verts_dumb_naive(
+        struct Chunk* chunk, struct ChunkMeshOptions options) {
+    size_t voxel_len = chunk->size.x * chunk->size.y * chunk->size.z;
+
+    // Counting pass, so the buffer is sized for the enabled voxels only 
+    // rather than for a completely full chunk.
+    size_t enabled = Chunk_count_enabled(chunk);
+
+    if (options.format != CHUNK_VERTEX_FLOAT3 || options.indexed)
+        return vc__create_verts_naive_faces(chunk, enabled, options);
+
+    struct vc__float_verts_t verts = vc__float_verts_create(
+        enabled * VERTS_PER_VOXEL);
+
+    float scale = (float)chunk->scale;
+    vc__emit_voxel_fn emit_voxel = vc__emit_voxel_kernel();
+
+    FE_DEBUG("%ld bytes allocated for chunk.", verts.cap * sizeof *verts.data); 
+
+    // this is probably an awful way to index. i havent decided how to do the 
+    // mapping. I hope this is correct though ..
+    for (size_t i = 0; i < voxel_len; ++i) {
+        if (!vc__chunk_enabled_index(chunk, i))
+            continue;
 
         struct Size3D pos = Chunk_get_iaspos(chunk, i);
 
         // vert = (pos_3v * scale + vpos_3v)
         // "local voxel pos times scale plus local chunk pos"
+        emit_voxel(verts.data + verts.len, 
+                   (float)pos.x, (float)pos.y, (float)pos.z, scale);
+        verts.len += VERTS_PER_VOXEL;
+    }
+
+    return verts;
+}
+
+void vc__float_verts_destroy(struct vc__float_verts_t* verts) {
+    BufferPool_free(Chunk_buffer_pool(), verts->data, 
+                    verts->cap * sizeof *verts->data);
+}
+
+/**
+ * @brief Grows `verts` so that at least `extra` more floats fit past
+ * `verts->len`. Capacity is doubled to amortize reallocations.
+ */
+static void vc__float_verts_reserve(struct vc__float_verts_t* verts, 
+                                    size_t extra) {
+    if (verts->len + extra <= verts->cap)
+        return;
+
+    size_t cap = verts->cap ? verts->cap : VERTS_PER_VOXEL;
+    while (cap < verts->len + extra)
+        cap *= 2;
+
+    size_t bytes = BufferPool_usable(cap * sizeof *verts->data);
+    verts->data = BufferPool_realloc(Chunk_buffer_pool(), verts->data, 
+                                     verts->cap * sizeof *verts->data, bytes);
+    verts->cap = bytes / sizeof *verts->data;
+}
+
+#define VC__FACE_VERTS (VERTICES_PER_POLYGON * POLYGONS_PER_FACE)
+#define VC__FACE_FLOATS (VC__FACE_VERTS * SCALARS_PER_VERTEX)
+#define VC__QUAD_VERTS 4
+
+/**
+ * Occupancy bitmap of a chunk. Every (y, z) pair owns a row of `words`
+ * 64-bit words, bit `x % 64` of word `x / 64` being set if the voxel at 
+ * (x, y, z) is enabled. Rows are padded by one row on every side in y 
+ * and z so that neighbor rows can be read without bounds checks, and 
+ * every row has a byte of `edges` telling whether the voxels just past 
+ * x = 0 (bit 0) and x = size.x - 1 (bit 1) are enabled. Padding is 
+ * filled from neighboring chunks when given, otherwise it is zero, i.e. 
+ * everything outside of the chunk is treated as air.
+ */
+struct vc__occupancy {
+    struct Size3D size;
+    size_t words;
+    uint64_t* rows;
+    uint8_t* edges;
+};
+
+#define VC__WORD_BITS 64
+
+#define VC__EDGE_NEG_X 0x1
+#define VC__EDGE_POS_X 0x2
+
+static inline size_t vc__occupancy_row_index(const struct vc__occupancy* occ,
+                                             int64_t y, int64_t z) {
+    return (size_t)(z + 1) * (occ->size.y + 2) + (size_t)(y + 1);
+}
+
+static inline uint64_t* vc__occupancy_row(struct vc__occupancy* occ, 
+                                          int64_t y, int64_t z) {
+    return occ->rows + vc__occupancy_row_index(occ, y, z) * occ->words;
+}
+
+static inline uint8_t vc__occupancy_edges(const struct vc__occupancy* occ, 
+                                          int64_t y, int64_t z) {
+    return occ->edges[vc__occupancy_row_index(occ, y, z)];
+}
+
+// Fixed size rows fit a single occupancy word, and the constant trip 
+// count lets the compiler unroll and vectorize the gather of the bits. 
+#define VC__DEFINE_FILL_ROW(n, log2) \
+    static inline void vc__occupancy_fill_row##n(const struct Voxel* voxel, \
+                                                 uint64_t* row) { \
+        uint64_t bits = 0; \
+        for (uint32_t x = 0; x < (n); ++x) \
+            bits |= (uint64_t)voxel[x].enabled << x; \
+        row[0] |= bits; \
+    }
+
+CHUNK_FIXED_SIZES(VC__DEFINE_FILL_ROW)
+#undef VC__DEFINE_FILL_ROW
+
+/**
+ * @brief Sets bits [x0, x1) of the occupancy row `row`.
+ */
+static inline void vc__row_set_range(uint64_t* row, size_t x0, size_t x1) {
+    while (x0 < x1) {
+        size_t bit = x0 % VC__WORD_BITS;
+        size_t n = x1 - x0 < VC__WORD_BITS - bit ? x1 - x0 : VC__WORD_BITS - bit;
+        row[x0 / VC__WORD_BITS] |= (n == VC__WORD_BITS 
+            ? ~0ULL : (1ULL << n) - 1) << bit;
+        x0 += n;
+    }
+}
+
+/**
+ * @brief ORs the enabled voxels of row (y, z) of `chunk` into `row`.
+ */
+static void vc__occupancy_fill_row(const struct Chunk* chunk, 
+                                   uint32_t y, uint32_t z, uint64_t* row) {
+    if (chunk->uniform) {
+        if (chunk->uniform_type == CHUNK_VOXEL_AIR)
+            return;
+        size_t words = (chunk->size.x + VC__WORD_BITS - 1) / VC__WORD_BITS;
+        for (size_t k = 0; k < words; ++k)
+            row[k] |= vc__row_mask(chunk->size.x, k);
+        return;
+    }
+
+    // linear runs are walked along the row rather than looked up per voxel
+    if (chunk->compressed && chunk->layout == CHUNK_LAYOUT_LINEAR) {
+        const struct ChunkRuns* runs = &chunk->runs;
+        size_t start = vc__chunk_row_of(chunk, y, z) * chunk->size.x;
+        size_t end = start + chunk->size.x;
+        for (size_t run = vc__runs_find(runs, start), from = start; 
+             from < end; ++run) {
+            size_t to = runs->ends[run] < end ? runs->ends[run] : end;
+            if (runs->values[run])
+                vc__row_set_range(row, from - start, to - start);
+            from = to;
+        }
+        return;
+    }
+
+    // bit chunk rows already have the occupancy layout 
+    if (chunk->storage == CHUNK_STORAGE_BITS && !chunk->compressed) {
+        const uint64_t* src = chunk->bits 
+            + vc__chunk_row_of(chunk, y, z) * chunk->row_words;
+        for (size_t k = 0; k < chunk->row_words; ++k)
+            row[k] |= src[k];
+        return;
+    }
+
+    if (chunk->storage == CHUNK_STORAGE_PALETTE 
+        || chunk->layout == CHUNK_LAYOUT_MORTON) {
+        for (uint32_t x = 0; x < chunk->size.x; ++x) {
+            row[x / VC__WORD_BITS] |= (uint64_t)vc__chunk_enabled(chunk, x, y, z) 
+                << (x % VC__WORD_BITS);
+        }
+        return;
+    }
+
+    const struct Voxel* voxel 
+        = chunk->voxels + ((size_t)z * chunk->size.y + y) * chunk->size.x;
+    switch (chunk->size_log2) {
+#define VC__FIXED_CASE(n, log2) \
+        case log2: vc__occupancy_fill_row##n(voxel, row); return;
+        CHUNK_FIXED_SIZES(VC__FIXED_CASE)
+#undef VC__FIXED_CASE
+        default: break;
+    }
+
+    for (uint32_t x = 0; x < chunk->size.x; ++x, ++voxel) {
+        row[x / VC__WORD_BITS] |= (uint64_t)voxel->enabled << (x % VC__WORD_BITS);
+    }
+}
+
+/**
+ * @brief Fills the padding of `occ` from the boundary voxels of 
+ * `neighbors`, indexed by `enum ChunkFace`. Missing neighbors and 
+ * neighbors of a different size are treated as air.
+ */
+static void vc__occupancy_pad(struct vc__occupancy* occ, 
+                              struct Chunk* const neighbors[CHUNK_FACE_COUNT]) {
+    struct Size3D size = occ->size;
+
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const struct Chunk* n = neighbors[face];
+        if (!n || (n->uniform && n->uniform_type == CHUNK_VOXEL_AIR))
+            continue;
+        if (n->size.x != size.x || n->size.y != size.y || n->size.z != size.z) {
+            FE_WARNING("Neighbor chunk size mismatch, not culling across face %d.",
+                       face);
+            continue;
+        }
+
+        switch (face) {
+            case CHUNK_FACE_NEG_X:
+            case CHUNK_FACE_POS_X: {
+                uint32_t x = face == CHUNK_FACE_NEG_X ? size.x - 1 : 0;
+                uint8_t flag = face == CHUNK_FACE_NEG_X 
+                    ? VC__EDGE_NEG_X : VC__EDGE_POS_X;
+                for (uint32_t z = 0; z < size.z; ++z) {
+                    for (uint32_t y = 0; y < size.y; ++y) {
+                        if (vc__chunk_enabled(n, x, y, z))
+                            occ->edges[vc__occupancy_row_index(occ, y, z)] |= flag;
+                    }
+                }
+                break;
+            }
+            case CHUNK_FACE_NEG_Y:
+            case CHUNK_FACE_POS_Y: {
+                uint32_t src = face == CHUNK_FACE_NEG_Y ? size.y - 1 : 0;
+                int64_t dst = face == CHUNK_FACE_NEG_Y ? -1 : (int64_t)size.y;
+                for (uint32_t z = 0; z < size.z; ++z)
+                    vc__occupancy_fill_row(n, src, z, vc__occupancy_row(occ, dst, z));
+                break;
+            }
+            default: {
+                uint32_t src = face == CHUNK_FACE_NEG_Z ? size.z - 1 : 0;
+                int64_t dst = face == CHUNK_FACE_NEG_Z ? -1 : (int64_t)size.z;
+                for (uint32_t y = 0; y < size.y; ++y)
+                    vc__occupancy_fill_row(n, y, src, vc__occupancy_row(occ, y, dst));
+                break;
+            }
+        }
+    }
+}
+
+static struct vc__occupancy vc__occupancy_build(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT]) {
+    struct vc__occupancy occ = { .size = chunk->size };
+    occ.words = (chunk->size.x + VC__WORD_BITS - 1) / VC__WORD_BITS;
 
-        // TODO: Multiply by scale, shift by local chunk coord
+    size_t row_count = (size_t)(chunk->size.y + 2) * (chunk->size.z + 2);
+    occ.rows = calloc(row_count * occ.words, sizeof *occ.rows);
+    occ.edges = calloc(row_count, sizeof *occ.edges);
+    if (!occ.rows || !occ.edges) {
+        FE_FATAL("Failed to allocate %lu bytes for chunk occupancy.",
+                 row_count * (occ.words * sizeof *occ.rows + sizeof *occ.edges));
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    for (uint32_t z = 0; z < chunk->size.z; ++z) {
+        for (uint32_t y = 0; y < chunk->size.y; ++y) {
+            vc__occupancy_fill_row(chunk, y, z, vc__occupancy_row(&occ, y, z));
+        }
+    }
+
+    if (neighbors)
+        vc__occupancy_pad(&occ, neighbors);
+
+    return occ;
+}
+
+static void vc__occupancy_destroy(struct vc__occupancy* occ) {
+    free(occ->rows);
+    free(occ->edges);
+}
+
+/**
+ * @brief Computes, for word `k` of `row`, the mask of voxels whose 
+ * `face` is visible, i.e. whose neighbor in the direction of `face` is 
+ * disabled. `neg` and `pos` are the rows adjacent along y or z; they are 
+ * ignored for the x faces, which shift within `row` instead and take the
+ * voxels past either end of the row from `edges`.
+ */
+static inline uint64_t vc__visible_mask(const struct vc__occupancy* occ,
+                                        enum ChunkFace face, 
+                                        const uint64_t* row, 
+                                        const uint64_t* neg,
+                                        const uint64_t* pos, 
+                                        uint8_t edges, size_t k) {
+    uint64_t self = row[k];
+    uint64_t next;
+
+    switch (face) {
+        case CHUNK_FACE_POS_X:
+            next = self >> 1;
+            if (k + 1 < occ->words) 
+                next |= row[k + 1] << (VC__WORD_BITS - 1);
+            else if (edges & VC__EDGE_POS_X)
+                next |= 1ULL << ((occ->size.x - 1) % VC__WORD_BITS);
+            break;
+        case CHUNK_FACE_NEG_X:
+            next = self << 1;
+            if (k > 0) 
+                next |= row[k - 1] >> (VC__WORD_BITS - 1);
+            else if (edges & VC__EDGE_NEG_X)
+                next |= 1ULL;
+            break;
+        case CHUNK_FACE_POS_Y:
+        case CHUNK_FACE_POS_Z:
+            next = pos[k];
+            break;
+        default:
+            next = neg[k];
+            break;
+    }
+
+    return self & ~next;
+}
+
+static inline bool vc__occupancy_get(const struct vc__occupancy* occ,
+                                     int64_t x, int64_t y, int64_t z) {
+    if (y < -1 || z < -1 || y > occ->size.y || z > occ->size.z)
+        return false;
+    if (x < 0)
+        return x == -1 && (vc__occupancy_edges(occ, y, z) & VC__EDGE_NEG_X);
+    if (x >= occ->size.x)
+        return x == occ->size.x 
+            && (vc__occupancy_edges(occ, y, z) & VC__EDGE_POS_X);
+
+    const uint64_t* row = occ->rows 
+        + vc__occupancy_row_index(occ, y, z) * occ->words;
+    return (row[x / VC__WORD_BITS] >> (x % VC__WORD_BITS)) & 1;
+}
+
+static const int vc__face_dirs[CHUNK_FACE_COUNT][3] = {
+    [CHUNK_FACE_NEG_Z] = {  0,  0, -1 },
+    [CHUNK_FACE_POS_X] = {  1,  0,  0 },
+    [CHUNK_FACE_POS_Z] = {  0,  0,  1 },
+    [CHUNK_FACE_NEG_X] = { -1,  0,  0 },
+    [CHUNK_FACE_POS_Y] = {  0,  1,  0 },
+    [CHUNK_FACE_NEG_Y] = {  0, -1,  0 },
+};
+
+/**
+ * @brief Whether the voxel at (x, y, z), relative to `chunk`, is enabled. 
+ * Positions one step outside of the chunk across one of its faces are 
+ * looked up in `neighbors`.
+ */
+static bool vc__enabled_at(const struct Chunk* chunk, 
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+                           int64_t x, int64_t y, int64_t z) {
+    struct Size3D size = chunk->size;
+    int face = -1;
+
+    if (x < 0) face = CHUNK_FACE_NEG_X, x += size.x;
+    else if (x >= size.x) face = CHUNK_FACE_POS_X, x -= size.x;
+    else if (y < 0) face = CHUNK_FACE_NEG_Y, y += size.y;
+    else if (y >= size.y) face = CHUNK_FACE_POS_Y, y -= size.y;
+    else if (z < 0) face = CHUNK_FACE_NEG_Z, z += size.z;
+    else if (z >= size.z) face = CHUNK_FACE_POS_Z, z -= size.z;
+
+    // Anything further out (chunk edges and corners) is treated as air,
+    // just like in the padding of `struct vc__occupancy`.
+    if (x < 0 || y < 0 || z < 0 || x >= size.x || y >= size.y || z >= size.z)
+        return false;
+    if (face < 0)
+        return vc__chunk_enabled(chunk, x, y, z);
+
+    const struct Chunk* n = neighbors ? neighbors[face] : NULL;
+    if (!n || n->size.x != size.x || n->size.y != size.y || n->size.z != size.z)
+        return false;
+    return vc__chunk_enabled(n, x, y, z);
+}
+
+/**
+ * State shared by the emitters of one mesh build. Occlusion is sampled 
+ * from `occ` when the mesher built one, otherwise from `chunk` and its
+ * `neighbors` directly.
+ */
+struct vc__emit_ctx {
+    enum ChunkVertexFormat format;
+    bool indexed;
+    float scale;
+    const struct vc__occupancy* occ;
+    const struct Chunk* chunk;
+    struct Chunk* const* neighbors;
+};
+
+static inline bool vc__emit_ctx_solid(const struct vc__emit_ctx* ctx,
+                                      int64_t x, int64_t y, int64_t z) {
+    return ctx->occ ? vc__occupancy_get(ctx->occ, x, y, z)
+                    : vc__enabled_at(ctx->chunk, ctx->neighbors, x, y, z);
+}
+
+/**
+ * Template vertices making up the 4 corners of a face in indexed meshes.
+ * Every template face is laid out as the triangles (a, b, c), (c, d, a), 
+ * so `vc__quad_indices` rebuilds them from these corners.
+ */
+static const int vc__quad_corners[VC__QUAD_VERTS] = { 0, 1, 2, 4 };
+static const uint32_t vc__quad_indices[VC__FACE_VERTS] = { 0, 1, 2, 2, 3, 0 };
+
+static inline size_t vc__face_verts(const struct vc__emit_ctx* ctx) {
+    return ctx->indexed ? VC__QUAD_VERTS : VC__FACE_VERTS;
+}
+
+/**
+ * @brief Scalars (floats or packed words) taken by one face.
+ */
+static inline size_t vc__face_scalars(const struct vc__emit_ctx* ctx) {
+    if (ctx->format == CHUNK_VERTEX_INSTANCED)
+        return CHUNK_FACE_RECORD_WORDS;
+    return vc__face_verts(ctx) 
+        * (ctx->format == CHUNK_VERTEX_PACKED ? 1 : SCALARS_PER_VERTEX);
+}
+
+/**
+ * @brief Whether faces in `format` carry per-vertex ambient occlusion.
+ */
+static inline bool vc__format_has_ao(enum ChunkVertexFormat format) {
+    return format != CHUNK_VERTEX_FLOAT3;
+}
+
+/**
+ * @brief Computes the ambient occlusion (0 = darkest, 3 = unoccluded) of 
+ * every template vertex of `face` of the voxel at (x, y, z), from the two 
+ * side voxels and the corner voxel in front of the face that touch it.
+ * @return Whether any vertex of the face is occluded.
+ */
+static bool vc__face_ao(const struct vc__emit_ctx* ctx, enum ChunkFace face,
+                        uint32_t x, uint32_t y, uint32_t z, 
+                        uint8_t ao[VC__FACE_VERTS]) {
+    const int* dir = vc__face_dirs[face];
+    int axis = dir[0] ? 0 : dir[1] ? 1 : 2;
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+    int64_t front[3] = { 
+        (int64_t)x + dir[0], (int64_t)y + dir[1], (int64_t)z + dir[2] };
+
+    bool occluded = false;
+    const struct vc__mesh_vertex* src = vc_vverts + face * VC__FACE_VERTS;
+    for (int i = 0; i < VC__FACE_VERTS; ++i) {
+        const float corner[3] = { src[i].x, src[i].y, src[i].z };
+        int64_t side_u[3] = { front[0], front[1], front[2] };
+        int64_t side_v[3] = { front[0], front[1], front[2] };
+        side_u[u] += corner[u] > 0.f ? 1 : -1;
+        side_v[v] += corner[v] > 0.f ? 1 : -1;
+        int64_t diag[3] = { side_u[0], side_u[1], side_u[2] };
+        diag[v] = side_v[v];
+
+        int s1 = vc__emit_ctx_solid(ctx, side_u[0], side_u[1], side_u[2]);
+        int s2 = vc__emit_ctx_solid(ctx, side_v[0], side_v[1], side_v[2]);
+        int c = vc__emit_ctx_solid(ctx, diag[0], diag[1], diag[2]);
+        ao[i] = (s1 && s2) ? 0 : (uint8_t)(3 - s1 - s2 - c);
+        occluded |= ao[i] < 3;
+    }
+
+    return occluded;
+}
+
+static inline uint32_t vc__pack_vertex(uint32_t x, uint32_t y, uint32_t z,
+                                       enum ChunkFace face, uint32_t ao,
+                                       uint32_t material) {
+    return (x << CHUNK_PACKED_X_SHIFT) 
+        | (y << CHUNK_PACKED_Y_SHIFT)
+        | (z << CHUNK_PACKED_Z_SHIFT)
+        | ((uint32_t)face << CHUNK_PACKED_FACE_SHIFT)
+        | (ao << CHUNK_PACKED_AO_SHIFT)
+        | (material << CHUNK_PACKED_MATERIAL_SHIFT);
+}
+
+/**
+ * @brief Appends the two triangles of `face` of the box spanning 
+ * `ex` * `ey` * `ez` voxels from (x, y, z). The template face is unit 
+ * sized with corners at 0 or 1, so stretching it per axis keeps the 
+ * winding intact. Packed and instanced single faces get per-vertex 
+ * occlusion; merged quads are only ever made of unoccluded faces.
+ */
+static void vc__emit_quad(struct vc__float_verts_t* verts, 
+                          const struct vc__emit_ctx* ctx, enum ChunkFace face,
+                          uint32_t x, uint32_t y, uint32_t z, 
+                          uint32_t ex, uint32_t ey, uint32_t ez) {
+    static const int all_verts[VC__FACE_VERTS] = { 0, 1, 2, 3, 4, 5 };
+    const struct vc__mesh_vertex* src = vc_vverts + face * VC__FACE_VERTS;
+    const int* order = ctx->indexed ? vc__quad_corners : all_verts;
+    size_t count = vc__face_verts(ctx);
+
+    vc__float_verts_reserve(verts, vc__face_scalars(ctx));
 
-        struct vc__mesh_vertex transverts[VC__MV_ELEMS] = {};
-        memcpy(transverts, vc_vverts, sizeof vc_vverts);
+    uint8_t ao[VC__FACE_VERTS] = { 3, 3, 3, 3, 3, 3 };
+    uint32_t material = 0;
+    if (vc__format_has_ao(ctx->format)) {
+        if (ex == 1 && ey == 1 && ez == 1)
+            vc__face_ao(ctx, face, x, y, z, ao);
+        material = vc__chunk_type(ctx->chunk, x, y, z) 
+            & CHUNK_PACKED_MATERIAL_MASK;
+    }
 
-        vec3 locvec = { (float)pos.x, (float)pos.y, (float)pos.z };
+    if (ctx->format == CHUNK_VERTEX_INSTANCED) {
+        uint32_t corners_ao = 0;
+        for (int i = 0; i < VC__QUAD_VERTS; ++i)
+            corners_ao |= (uint32_t)ao[vc__quad_corners[i]] << (2 * i);
 
-        for (int i = 0; i < VC__MV_ELEMS; ++i) {
-            //glm_vec3_add((float*)&transverts[i], locvec, (float*)&transverts[i]);
-            transverts[i].x += pos.x;
-            transverts[i].y += pos.y;
-            transverts[i].z += pos.z;
+        uint32_t* dst = verts->packed + verts->len;
+        dst[0] = vc__pack_vertex(x, y, z, face, 0, material);
+        dst[1] = ((ex - 1) << CHUNK_FACE_EXTENT_X_SHIFT)
+            | ((ey - 1) << CHUNK_FACE_EXTENT_Y_SHIFT)
+            | ((ez - 1) << CHUNK_FACE_EXTENT_Z_SHIFT)
+            | (corners_ao << CHUNK_FACE_AO_SHIFT);
+        verts->len += CHUNK_FACE_RECORD_WORDS;
+        return;
+    }
 
-            transverts[i].x *= scale;
-            transverts[i].y *= scale;
-            transverts[i].z *= scale;
+    if (ctx->format == CHUNK_VERTEX_PACKED) {
+        uint32_t* dst = verts->packed + verts->len;
+        for (size_t i = 0; i < count; ++i) {
+            const struct vc__mesh_vertex* v = src + order[i];
+            *dst++ = vc__pack_vertex((uint32_t)v->x * ex + x,
+                                     (uint32_t)v->y * ey + y,
+                                     (uint32_t)v->z * ez + z,
+                                     face, ao[order[i]], material);
         }
+        verts->len += count;
+        return;
+    }
+
+    float scale = ctx->scale;
+    float* dst = verts->data + verts->len;
+    for (size_t i = 0; i < count; ++i) {
+        const struct vc__mesh_vertex* v = src + order[i];
+        *dst++ = (v->x * (float)ex + (float)x) * scale;
+        *dst++ = (v->y * (float)ey + (float)y) * scale;
+        *dst++ = (v->z * (float)ez + (float)z) * scale;
+    }
+
+    verts->len += count * SCALARS_PER_VERTEX;
+}
+
+/**
+ * @brief Appends the two triangles of `face` of the voxel at (x, y, z).
+ */
+static inline void vc__emit_face(struct vc__float_verts_t* verts, 
+                                 const struct vc__emit_ctx* ctx,
+                                 enum ChunkFace face, 
+                                 uint32_t x, uint32_t y, uint32_t z) {
+    vc__emit_quad(verts, ctx, face, x, y, z, 1, 1, 1);
+}
 
-        memcpy(verts.data + verts.len, transverts, sizeof vc_vverts);
-        //verts.len += 18 * 4;
-        verts.len += sizeof (vc_vverts) / sizeof vc_vverts[0] * 3;
+/**
+ * @brief Variant of the naive mesher for packed, instanced or indexed 
+ * meshes, which 
+ * emits the faces of every enabled voxel one by one rather than copying 
+ * the whole voxel template, so they can carry their own occlusion.
+ */
+static struct vc__float_verts_t vc__create_verts_naive_faces(
+        struct Chunk* chunk, size_t enabled, struct ChunkMeshOptions options) {
+    struct vc__emit_ctx ctx = { 
+        .format = options.format, .indexed = options.indexed,
+        .scale = (float)chunk->scale, .chunk = chunk };
+    struct vc__float_verts_t verts = vc__float_verts_create(
+        enabled * CHUNK_FACE_COUNT * vc__face_scalars(&ctx));
+
+    size_t voxel_len = chunk->size.x * chunk->size.y * chunk->size.z;
+    for (size_t i = 0; i < voxel_len; ++i) {
+        if (!vc__chunk_enabled_index(chunk, i))
+            continue;
+
+        struct Size3D pos = Chunk_get_iaspos(chunk, i);
+        for (int face = 0; face < CHUNK_FACE_COUNT; ++face)
+            vc__emit_face(&verts, &ctx, face, pos.x, pos.y, pos.z);
     }
 
     return verts;
 }
 
-void vc__float_verts_destroy(struct vc__float_verts_t* verts) {
-    free(verts->data);
+/**
+ * @brief (Re)allocates `slots` for `chunk` with no faces meshed. The 
+ * owner table is sized for every face of every voxel, so it never needs
+ * to grow while edits are applied.
+ */
+static void vc__face_slots_reset(struct vc__face_slots_t* slots, 
+                                 struct Chunk* chunk) {
+    size_t faces = (size_t)chunk->size.x * chunk->size.y * chunk->size.z
+        * CHUNK_FACE_COUNT;
+
+    free(slots->owner);
+    free(slots->slot_of);
+    slots->len = 0;
+    slots->owner = malloc(faces * sizeof *slots->owner);
+    slots->slot_of = malloc(faces * sizeof *slots->slot_of);
+    if (!slots->owner || !slots->slot_of) {
+        FE_FATAL("Failed to allocate %lu bytes for face slots.",
+                 faces * (sizeof *slots->owner + sizeof *slots->slot_of));
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    memset(slots->slot_of, 0xFF, faces * sizeof *slots->slot_of);
+}
+
+static void vc__face_slots_destroy(struct vc__face_slots_t* slots) {
+    free(slots->owner);
+    free(slots->slot_of);
+    *slots = (struct vc__face_slots_t){};
+}
+
+/**
+ * @brief Records that the next face slot is `face` of voxel `idx`.
+ */
+static inline void vc__face_slots_push(struct vc__face_slots_t* slots,
+                                       size_t idx, enum ChunkFace face) {
+    uint32_t key = (uint32_t)(idx * CHUNK_FACE_COUNT + face);
+    slots->owner[slots->len] = key;
+    slots->slot_of[key] = (uint32_t)slots->len;
+    ++slots->len;
+}
+
+/**
+ * @brief Counting pass of the culling mesher: the number of visible faces
+ * in `occ`, as the sum of the popcounts of every visible mask.
+ */
+static size_t vc__count_visible_faces(struct vc__occupancy* occ) {
+    size_t count = 0;
+
+    for (uint32_t z = 0; z < occ->size.z; ++z) {
+        for (uint32_t y = 0; y < occ->size.y; ++y) {
+            const uint64_t* row = vc__occupancy_row(occ, y, z);
+            const uint64_t* ny = vc__occupancy_row(occ, (int64_t)y - 1, z);
+            const uint64_t* py = vc__occupancy_row(occ, (int64_t)y + 1, z);
+            const uint64_t* nz = vc__occupancy_row(occ, y, (int64_t)z - 1);
+            const uint64_t* pz = vc__occupancy_row(occ, y, (int64_t)z + 1);
+            uint8_t edges = vc__occupancy_edges(occ, y, z);
+
+            for (size_t k = 0; k < occ->words; ++k) {
+                uint64_t self = row[k];
+                count += __builtin_popcountll(self & ~ny[k]);
+                count += __builtin_popcountll(self & ~py[k]);
+                count += __builtin_popcountll(self & ~nz[k]);
+                count += __builtin_popcountll(self & ~pz[k]);
+                count += __builtin_popcountll(vc__visible_mask(
+                    occ, CHUNK_FACE_POS_X, row, row, row, edges, k));
+                count += __builtin_popcountll(vc__visible_mask(
+                    occ, CHUNK_FACE_NEG_X, row, row, row, edges, k));
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Hidden-face culling mesher. Only faces whose neighbor is 
+ * disabled (or lies outside of the chunk) are emitted. Visibility is 
+ * computed a whole occupancy word at a time, and only set bits of the 
+ * resulting masks are visited.
+ */
+struct vc__float_verts_t vc__create_verts_culled(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options, struct vc__face_slots_t* slots) {
+    struct vc__occupancy occ = vc__occupancy_build(chunk, neighbors);
+    struct vc__emit_ctx ctx = { 
+        .format = options.format, .indexed = options.indexed,
+        .scale = (float)chunk->scale, .occ = &occ, .chunk = chunk };
+    struct vc__float_verts_t verts = vc__float_verts_create(
+        vc__count_visible_faces(&occ) * vc__face_scalars(&ctx));
+    if (slots)
+        vc__face_slots_reset(slots, chunk);
+
+    for (uint32_t z = 0; z < chunk->size.z; ++z) {
+        for (uint32_t y = 0; y < chunk->size.y; ++y) {
+            const uint64_t* row = vc__occupancy_row(&occ, y, z);
+            uint8_t edges = vc__occupancy_edges(&occ, y, z);
+            const uint64_t* rows_y[2] = { 
+                vc__occupancy_row(&occ, (int64_t)y - 1, z),
+                vc__occupancy_row(&occ, (int64_t)y + 1, z) };
+            const uint64_t* rows_z[2] = { 
+                vc__occupancy_row(&occ, y, (int64_t)z - 1),
+                vc__occupancy_row(&occ, y, (int64_t)z + 1) };
+
+            for (int face = 0; face < FACES_PER_VOXEL; ++face) {
+                const uint64_t** adj = 
+                    (face == CHUNK_FACE_NEG_Z || face == CHUNK_FACE_POS_Z) 
+                    ? rows_z : rows_y;
+
+                for (size_t k = 0; k < occ.words; ++k) {
+                    uint64_t mask = vc__visible_mask(&occ, face, row, 
+                                                     adj[0], adj[1], edges, k);
+                    while (mask) {
+                        uint32_t x = (uint32_t)(k * VC__WORD_BITS) 
+                            + (uint32_t)__builtin_ctzll(mask);
+                        vc__emit_face(&verts, &ctx, face, x, y, z);
+                        if (slots) {
+                            size_t idx = ((size_t)z * chunk->size.y + y) 
+                                * chunk->size.x + x;
+                            vc__face_slots_push(slots, idx, face);
+                        }
+                        mask &= mask - 1;
+                    }
+                }
+            }
+        }
+    }
+
+    vc__occupancy_destroy(&occ);
+
+    FE_DEBUG("%ld bytes used by culled chunk mesh.", verts.len * sizeof *verts.data);
+    return verts;
+}
+
+/**
+ * @brief Maps the cell (u, v) of slice `slice` of the planes of `face`
+ * back to voxel coordinates.
+ */
+static inline void vc__plane_to_voxel(enum ChunkFace face, uint32_t slice,
+                                      uint32_t u, uint32_t v, uint32_t* x,
+                                      uint32_t* y, uint32_t* z) {
+    switch (face) {
+        case CHUNK_FACE_POS_X:
+        case CHUNK_FACE_NEG_X: // u = y, v = z
+            *x = slice, *y = u, *z = v;
+            break;
+        case CHUNK_FACE_POS_Y:
+        case CHUNK_FACE_NEG_Y: // u = x, v = z
+            *x = u, *y = slice, *z = v;
+            break;
+        default: // u = x, v = y
+            *x = u, *y = v, *z = slice;
+            break;
+    }
+}
+
+/**
+ * @brief Type of the voxel at (u, v) of a slice.
+ */
+static uint16_t vc__plane_type(const struct vc__emit_ctx* ctx, 
+                               enum ChunkFace face, uint32_t slice, 
+                               uint32_t u, uint32_t v) {
+    uint32_t x, y, z;
+    vc__plane_to_voxel(face, slice, u, v, &x, &y, &z);
+    return vc__chunk_type(ctx->chunk, x, y, z);
+}
+
+/**
+ * @brief Returns how many of the `du` voxels from (u, v) of a slice in a
+ * row are of type `type`.
+ */
+static uint32_t vc__plane_run_of_type(const struct vc__emit_ctx* ctx, 
+                                      enum ChunkFace face, uint32_t slice, 
+                                      uint32_t u, uint32_t v, uint32_t du,
+                                      uint16_t type) {
+    uint32_t run = 0;
+    while (run < du && vc__plane_type(ctx, face, slice, u + run, v) == type)
+        ++run;
+    return run;
+}
+
+/**
+ * @brief Merges the set bits of a slice `plane` of `v_len` rows of `u_words`
+ * words each into maximal rectangles and emits one quad per rectangle. 
+ * Runs are grown along u within a word, then extended along v for as long 
+ * as the next row contains the whole run. `plane` is consumed. 
+ *
+ * Occlusion can differ from face to face, so when emitting packed vertices
+ * or face records, occluded faces are emitted on their own before merging
+ * the rest, and runs only merge faces of the same voxel type (material).
+ */
+static void vc__greedy_plane(struct vc__float_verts_t* verts, 
+                             const struct vc__emit_ctx* ctx,
+                             enum ChunkFace face, uint32_t slice, 
+                             uint64_t* plane, uint32_t v_len, 
+                             size_t u_words) {
+    uint32_t x, y, z;
+
+    if (vc__format_has_ao(ctx->format)) {
+        for (uint32_t v = 0; v < v_len; ++v) {
+            for (size_t k = 0; k < u_words; ++k) {
+                uint64_t bits = plane[v * u_words + k];
+                while (bits) {
+                    uint32_t bit = (uint32_t)__builtin_ctzll(bits);
+                    bits &= bits - 1;
+
+                    uint8_t ao[VC__FACE_VERTS];
+                    vc__plane_to_voxel(face, slice, 
+                                       (uint32_t)(k * VC__WORD_BITS) + bit,
+                                       v, &x, &y, &z);
+                    if (vc__face_ao(ctx, face, x, y, z, ao)) {
+                        vc__emit_face(verts, ctx, face, x, y, z);
+                        plane[v * u_words + k] &= ~(1ULL << bit);
+                    }
+                }
+            }
+        }
+    }
+
+    // Only chunks with a palette can have differing types
+    bool typed = vc__format_has_ao(ctx->format) 
+        && ctx->chunk->storage == CHUNK_STORAGE_PALETTE;
+
+    for (uint32_t v = 0; v < v_len; ++v) {
+        for (size_t k = 0; k < u_words; ++k) {
+            uint64_t* word = plane + v * u_words + k;
+
+            while (*word) {
+                uint32_t start = (uint32_t)__builtin_ctzll(*word);
+                uint64_t run = ~(*word >> start);
+                uint32_t du = run ? (uint32_t)__builtin_ctzll(run) 
+                                  : VC__WORD_BITS - start;
+                uint32_t u0 = (uint32_t)(k * VC__WORD_BITS) + start;
+                uint16_t type = 0;
+                if (typed) {
+                    type = vc__plane_type(ctx, face, slice, u0, v);
+                    du = vc__plane_run_of_type(ctx, face, slice, u0, v, du, type);
+                }
+                uint64_t run_mask = (du == VC__WORD_BITS ? ~0ULL 
+                                     : ((1ULL << du) - 1)) << start;
+
+                uint32_t dv = 1;
+                for (uint32_t next = v + 1; next < v_len; ++next, ++dv) {
+                    uint64_t* below = plane + next * u_words + k;
+                    if ((*below & run_mask) != run_mask)
+                        break;
+                    if (typed && vc__plane_run_of_type(
+                            ctx, face, slice, u0, next, du, type) != du) {
+                        break;
+                    }
+                    *below &= ~run_mask;
+                }
+                *word &= ~run_mask;
+
+                vc__plane_to_voxel(face, slice, u0, v, &x, &y, &z);
+                switch (face) {
+                    case CHUNK_FACE_POS_X:
+                    case CHUNK_FACE_NEG_X:
+                        vc__emit_quad(verts, ctx, face, x, y, z, 1, du, dv);
+                        break;
+                    case CHUNK_FACE_POS_Y:
+                    case CHUNK_FACE_NEG_Y:
+                        vc__emit_quad(verts, ctx, face, x, y, z, du, 1, dv);
+                        break;
+                    default:
+                        vc__emit_quad(verts, ctx, face, x, y, z, du, dv, 1);
+                        break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Greedy mesher. Visible faces (as computed by the culling mesher) 
+ * are merged into maximal coplanar rectangles per slice and axis, so large
+ * flat areas collapse into a handful of quads.
+ */
+struct vc__float_verts_t vc__create_verts_greedy(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options) {
+    struct Size3D size = chunk->size;
+
+    // Merged quads never outnumber the visible faces, so the face count
+    // bounds the buffer; it is trimmed to the final size below.
+    struct vc__occupancy occ = vc__occupancy_build(chunk, neighbors);
+    struct vc__emit_ctx ctx = { 
+        .format = options.format, .indexed = options.indexed,
+        .scale = (float)chunk->scale, .occ = &occ, .chunk = chunk };
+    struct vc__float_verts_t verts = vc__float_verts_create(
+        vc__count_visible_faces(&occ) * vc__face_scalars(&ctx));
+
+    // The largest slice is either (x, z), (x, y) with x packed in words,
+    // or (y, z) with y packed in words.
+    size_t y_words = (size.y + VC__WORD_BITS - 1) / VC__WORD_BITS;
+    size_t plane_words = occ.words * (size.y > size.z ? size.y : size.z);
+    if (y_words * size.z > plane_words)
+        plane_words = y_words * size.z;
+
+    uint64_t* plane = malloc(plane_words * sizeof *plane);
+    if (!plane) {
+        FE_FATAL("Failed to allocate %lu bytes for greedy mesher.", 
+                 plane_words * sizeof *plane);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    for (int face = 0; face < FACES_PER_VOXEL; ++face) {
+        int dz = face == CHUNK_FACE_POS_Z ? 1 : face == CHUNK_FACE_NEG_Z ? -1 : 0;
+        int dy = face == CHUNK_FACE_POS_Y ? 1 : face == CHUNK_FACE_NEG_Y ? -1 : 0;
+
+        if (face == CHUNK_FACE_POS_X || face == CHUNK_FACE_NEG_X) {
+            for (uint32_t x = 0; x < size.x; ++x) {
+                memset(plane, 0, y_words * size.z * sizeof *plane);
+                size_t k = x / VC__WORD_BITS;
+                uint32_t bit = x % VC__WORD_BITS;
+
+                for (uint32_t z = 0; z < size.z; ++z) {
+                    uint64_t* dst = plane + z * y_words;
+                    for (uint32_t y = 0; y < size.y; ++y) {
+                        const uint64_t* row = vc__occupancy_row(&occ, y, z);
+                        uint64_t mask = vc__visible_mask(
+                            &occ, face, row, row, row, 
+                            vc__occupancy_edges(&occ, y, z), k);
+                        dst[y / VC__WORD_BITS] 
+                            |= ((mask >> bit) & 1) << (y % VC__WORD_BITS);
+                    }
+                }
+
+                vc__greedy_plane(&verts, &ctx, face, x, plane, size.z, 
+                                 y_words);
+            }
+            continue;
+        }
+
+        // y and z faces keep x packed in words, so slice rows are the 
+        // visible masks of occupancy rows as-is.
+        uint32_t slices = dy ? size.y : size.z;
+        uint32_t v_len = dy ? size.z : size.y;
+        for (uint32_t d = 0; d < slices; ++d) {
+            for (uint32_t v = 0; v < v_len; ++v) {
+                uint32_t y = dy ? d : v;
+                uint32_t z = dy ? v : d;
+                const uint64_t* row = vc__occupancy_row(&occ, y, z);
+                const uint64_t* adj = vc__occupancy_row(
+                    &occ, (int64_t)y + dy, (int64_t)z + dz);
+
+                for (size_t k = 0; k < occ.words; ++k) {
+                    plane[v * occ.words + k] 
+                        = vc__visible_mask(&occ, face, row, adj, adj, 0, k);
+                }
+            }
+
+            vc__greedy_plane(&verts, &ctx, face, d, plane, v_len, 
+                             occ.words);
+        }
+    }
+
+    free(plane);
+    vc__occupancy_destroy(&occ);
+
+    // only moves the buffer if it shrinks to a smaller size class 
+    size_t bytes = BufferPool_usable(verts.len * sizeof *verts.data);
+    if (bytes < verts.cap * sizeof *verts.data) {
+        verts.data = BufferPool_realloc(Chunk_buffer_pool(), verts.data, 
+                                        verts.cap * sizeof *verts.data, bytes);
+        verts.cap = bytes / sizeof *verts.data;
+    }
+
+    FE_DEBUG("%ld bytes used by greedy chunk mesh.", verts.len * sizeof *verts.data);
+    return verts;
+}
+
+/**
+ * @brief Whether `chunk` meshes to nothing without looking at its voxels:
+ * it is uniformly air, or uniformly solid and enclosed on every side by 
+ * uniformly solid neighbors, which the naive mesher does not cull against.
+ */
+static bool vc__mesh_empty(const struct Chunk* chunk, 
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+                           struct ChunkMeshOptions options) {
+    if (!chunk->uniform)
+        return false;
+    if (chunk->uniform_type == CHUNK_VOXEL_AIR)
+        return true;
+    if (!neighbors || options.mesher == CHUNK_MESHER_NAIVE)
+        return false;
+
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const struct Chunk* n = neighbors[face];
+        if (!n || !n->uniform || n->uniform_type == CHUNK_VOXEL_AIR
+            || n->size.x != chunk->size.x || n->size.y != chunk->size.y 
+            || n->size.z != chunk->size.z)
+            return false;
+    }
+    return true;
+}
+
+static struct vc__float_verts_t vc__create_verts(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options, struct vc__face_slots_t* slots) {
+    if (vc__mesh_empty(chunk, neighbors, options)) {
+        // edits are still tracked from the (empty) mesh 
+        if (slots)
+            vc__face_slots_reset(slots, chunk);
+        return (struct vc__float_verts_t){ 0 };
+    }
+
+    switch (options.mesher) {
+        case CHUNK_MESHER_NAIVE:
+            return vc__create_verts_dumb_naive(chunk, options);
+        case CHUNK_MESHER_CULLED:
+            return vc__create_verts_culled(chunk, neighbors, options, slots);
+        case CHUNK_MESHER_GREEDY:
+            return vc__create_verts_greedy(chunk, neighbors, options);
+        default:
+            FE_WARNING("Unknown chunk mesher %d, falling back to culled.", 
+                       options.mesher);
+            return vc__create_verts_culled(chunk, neighbors, options, slots);
+    }
 }
 
-// TODO: Look into "recycling" existing chunk data to optimize rebuild
-// times (for when only a few voxels are destroy), but maybe not 
-// necessary with sufficiently efficient renderers.
-struct ChunkMesh ChunkMesh__from_chunk(struct Chunk* chunk) {
-    struct ChunkMesh mesh = {};
+// Element buffer shared by every indexed chunk mesh, holding the indices
+// of the first `vc__quad_ebo_quads` quads. Only ever grows.
+static GLuint vc__quad_ebo = 0;
+static size_t vc__quad_ebo_quads = 0;
 
-    struct vc__float_verts_t verts = vc__create_verts_dumb_naive(chunk);
-    mesh.verts = verts;
+/**
+ * @brief Grows the shared quad element buffer to cover at least `quads`
+ * quads. It is filled through the copy-write target so that the element
+ * array binding of whichever VAO is bound is left alone.
+ */
+static void vc__quad_ebo_reserve(size_t quads) {
+    if (vc__quad_ebo && quads <= vc__quad_ebo_quads)
+        return;
 
-    glGenVertexArrays(1, &mesh.vao);
-    glGenBuffers(1, &mesh.vbo);
+    size_t cap = vc__quad_ebo_quads ? vc__quad_ebo_quads : 1024;
+    while (cap < quads)
+        cap *= 2;
 
-    glBindVertexArray(mesh.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    uint32_t* indices = malloc(cap * VC__FACE_VERTS * sizeof *indices);
+    if (!indices) {
+        FE_FATAL("Failed to allocate %lu bytes for quad indices.",
+                 cap * VC__FACE_VERTS * sizeof *indices);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    for (size_t q = 0; q < cap; ++q) {
+        for (int i = 0; i < VC__FACE_VERTS; ++i) {
+            indices[q * VC__FACE_VERTS + i] 
+                = (uint32_t)(q * VC__QUAD_VERTS) + vc__quad_indices[i];
+        }
+    }
 
-    glBufferData(GL_ARRAY_BUFFER, verts.len * sizeof (float), 
-                 verts.data, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof (float), (void*)0);
-    glEnableVertexAttribArray(0);
+    if (!vc__quad_ebo)
+        glGenBuffers(1, &vc__quad_ebo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vc__quad_ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, cap * VC__FACE_VERTS * sizeof *indices,
+                 indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
+    free(indices);
+    vc__quad_ebo_quads = cap;
+}
+
+/**
+ * @brief Uploads the whole vertex buffer of `mesh`, reserving GPU storage
+ * for its full CPU capacity so later incremental edits can grow in place.
+ */
+static void vc__mesh_upload(struct ChunkMesh* mesh) {
+    mesh->gpu_cap = mesh->verts.cap > mesh->verts.len 
+        ? mesh->verts.cap : mesh->verts.len;
+
+    if (mesh->options.indexed) {
+        size_t per_quad = VC__QUAD_VERTS 
+            * (mesh->options.format == CHUNK_VERTEX_PACKED ? 1 : SCALARS_PER_VERTEX);
+        vc__quad_ebo_reserve(mesh->gpu_cap / per_quad);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(GL_ARRAY_BUFFER, mesh->gpu_cap * sizeof *mesh->verts.data, 
+                 NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, 
+                    mesh->verts.len * sizeof *mesh->verts.data, 
+                    mesh->verts.data);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+}
+
+struct ChunkMesh ChunkMesh__from_chunk(struct Chunk* chunk, 
+                                       struct ChunkMeshOptions options) {
+    return ChunkMesh__from_chunk_neighbors(chunk, NULL, options);
+}
 
-    //vc__float_verts_destroy(&verts);
+struct ChunkMesh ChunkMesh__from_chunk_neighbors(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options) {
+    struct ChunkMesh mesh = ChunkMesh__build(chunk, neighbors, options);
+    ChunkMesh_upload(&mesh);
     return mesh;
 }
 
+struct ChunkMesh ChunkMesh__build(
+        struct Chunk* chunk, struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+        struct ChunkMeshOptions options) {
+    if (options.format != CHUNK_VERTEX_FLOAT3 
+        && (chunk->size.x > CHUNK_PACKED_MAX_SIZE 
+            || chunk->size.y > CHUNK_PACKED_MAX_SIZE
+            || chunk->size.z > CHUNK_PACKED_MAX_SIZE)) {
+        FE_WARNING("Chunk of size (%u, %u, %u) is too large for packed "
+                   "vertices, falling back to float vertices.",
+                   chunk->size.x, chunk->size.y, chunk->size.z);
+        options.format = CHUNK_VERTEX_FLOAT3;
+    }
+
+    if (options.format == CHUNK_VERTEX_INSTANCED)
+        options.indexed = false;
+
+    struct ChunkMesh mesh = { .options = options };
+    mesh.verts = vc__create_verts(chunk, neighbors, options, NULL);
+    return mesh;
+}
+
+void ChunkMesh_upload(struct ChunkMesh* mesh) {
+    if (mesh->vao) {
+        vc__mesh_upload(mesh);
+        return;
+    }
+
+    glGenVertexArrays(1, &mesh->vao);
+    glGenBuffers(1, &mesh->vbo);
+
+    glBindVertexArray(mesh->vao);
+    vc__mesh_upload(mesh);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    if (mesh->options.indexed)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vc__quad_ebo);
+    if (mesh->options.format == CHUNK_VERTEX_INSTANCED) {
+        // The quad itself comes from gl_VertexID, so the face record is 
+        // the only attribute.
+        glVertexAttribIPointer(2, CHUNK_FACE_RECORD_WORDS, GL_UNSIGNED_INT, 
+                               CHUNK_FACE_RECORD_WORDS * sizeof (uint32_t), 
+                               (void*)0);
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(2);
+    } else if (mesh->options.format == CHUNK_VERTEX_PACKED) {
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof (uint32_t), (void*)0);
+        glEnableVertexAttribArray(1);
+    } else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof (float), (void*)0);
+        glEnableVertexAttribArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void ChunkMesh_edit_voxel(struct ChunkMesh* mesh, struct Chunk* chunk,
+                          struct Size3D pos, bool enabled) {
+    if (pos.x < chunk->size.x && pos.y < chunk->size.y && pos.z < chunk->size.z
+        && Chunk_is_set(chunk, pos) == enabled)
+        return;
+
+    ChunkMesh_edit_voxel_type(mesh, chunk, pos, 
+                              enabled ? CHUNK_VOXEL_SOLID : CHUNK_VOXEL_AIR);
+}
+
+void ChunkMesh_edit_voxel_type(struct ChunkMesh* mesh, struct Chunk* chunk,
+                               struct Size3D pos, uint16_t type) {
+    if (pos.x >= chunk->size.x || pos.y >= chunk->size.y 
+        || pos.z >= chunk->size.z) {
+        FE_WARNING("Voxel edit at (%u, %u, %u) is outside of the chunk.",
+                   pos.x, pos.y, pos.z);
+        return;
+    }
+
+    size_t idx = vc__chunk_index(chunk, pos.x, pos.y, pos.z);
+    if (vc__chunk_type(chunk, pos.x, pos.y, pos.z) == type)
+        return;
+    vc__chunk_set_type(chunk, pos, type);
+
+    struct vc__dirty_voxels_t* dirty = &mesh->dirty;
+    if (dirty->len == dirty->cap) {
+        size_t cap = dirty->cap ? dirty->cap * 2 : 16;
+        size_t* data = realloc(dirty->data, cap * sizeof *data);
+        if (!data) {
+            FE_FATAL("Failed to allocate %lu bytes for dirty voxels.",
+                     cap * sizeof *data);
+            exit(FE_ERR_BAD_ALLOC);
+        }
+        dirty->data = data;
+        dirty->cap = cap;
+    }
+    dirty->data[dirty->len++] = idx;
+}
+
+/**
+ * @brief Brings `face` of the voxel at (x, y, z) in line with the chunk:
+ * a missing visible face is appended, a meshed hidden face is removed by
+ * moving the last face into its slot, and with `refresh` a face that 
+ * stays meshed is rewritten in place (its occlusion may have changed). 
+ * The range of slots written to is accumulated in [`*lo`, `*hi`).
+ */
+static void vc__patch_face(struct ChunkMesh* mesh, 
+                           const struct vc__emit_ctx* ctx,
+                           uint32_t x, uint32_t y, uint32_t z, 
+                           enum ChunkFace face, bool refresh, 
+                           size_t* lo, size_t* hi) {
+    const struct Chunk* chunk = ctx->chunk;
+    struct vc__face_slots_t* slots = &mesh->slots;
+    size_t idx = ((size_t)z * chunk->size.y + y) * chunk->size.x + x;
+    uint32_t key = (uint32_t)(idx * CHUNK_FACE_COUNT + face);
+    size_t stride = vc__face_scalars(ctx);
+
+    const int* dir = vc__face_dirs[face];
+    bool visible = vc__chunk_enabled(chunk, x, y, z) 
+        && !vc__enabled_at(chunk, ctx->neighbors, 
+                           (int64_t)x + dir[0], (int64_t)y + dir[1], 
+                           (int64_t)z + dir[2]);
+    uint32_t slot = slots->slot_of[key];
+
+    if (visible && slot == VC__NO_SLOT) {
+        size_t at = slots->len;
+        vc__emit_face(&mesh->verts, ctx, face, x, y, z);
+        vc__face_slots_push(slots, idx, face);
+        if (at < *lo) *lo = at;
+        if (at + 1 > *hi) *hi = at + 1;
+    } else if (visible && refresh) {
+        // emit past the end, then move it over the old face
+        vc__emit_face(&mesh->verts, ctx, face, x, y, z);
+        mesh->verts.len -= stride;
+        memcpy(mesh->verts.data + slot * stride, 
+               mesh->verts.data + mesh->verts.len,
+               stride * sizeof *mesh->verts.data);
+        if (slot < *lo) *lo = slot;
+        if (slot + 1 > *hi) *hi = slot + 1;
+    } else if (!visible && slot != VC__NO_SLOT) {
+        size_t last = slots->len - 1;
+        if (slot != last) {
+            memcpy(mesh->verts.data + slot * stride,
+                   mesh->verts.data + last * stride,
+                   stride * sizeof *mesh->verts.data);
+            slots->owner[slot] = slots->owner[last];
+            slots->slot_of[slots->owner[slot]] = slot;
+            if (slot < *lo) *lo = slot;
+            if (slot + 1 > *hi) *hi = slot + 1;
+        }
+        slots->slot_of[key] = VC__NO_SLOT;
+        slots->len = last;
+        mesh->verts.len -= stride;
+    }
+}
+
+/**
+ * @brief Remeshes `mesh` from scratch and re-uploads it. Culled meshes 
+ * start tracking face slots so that later edits can be applied in place.
+ */
+static void vc__mesh_rebuild(struct ChunkMesh* mesh, struct Chunk* chunk,
+                             struct Chunk* const neighbors[CHUNK_FACE_COUNT]) {
+    vc__float_verts_destroy(&mesh->verts);
+
+    struct vc__face_slots_t* slots = mesh->options.mesher == CHUNK_MESHER_CULLED 
+        ? &mesh->slots : NULL;
+    mesh->verts = vc__create_verts(chunk, neighbors, mesh->options, slots);
+    vc__mesh_upload(mesh);
+}
+
+void ChunkMesh_flush_edits(struct ChunkMesh* mesh, struct Chunk* chunk,
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT]) {
+    struct vc__dirty_voxels_t* dirty = &mesh->dirty;
+    if (dirty->len == 0)
+        return;
+
+    if (!mesh->slots.owner || dirty->len > CHUNK_MESH_MAX_INCREMENTAL_EDITS) {
+        FE_DEBUG("Rebuilding chunk mesh after %lu edits.", dirty->len);
+        vc__mesh_rebuild(mesh, chunk, neighbors);
+        dirty->len = 0;
+        return;
+    }
+
+    struct vc__emit_ctx ctx = { 
+        .format = mesh->options.format, .indexed = mesh->options.indexed,
+        .scale = (float)chunk->scale, .chunk = chunk, .neighbors = neighbors };
+    size_t stride = vc__face_scalars(&ctx);
+
+    // Without occlusion, an edit only changes the voxel's own faces and
+    // the faces its neighbors turn towards it. Occlusion also depends on
+    // the diagonal neighbors, so packed and instanced meshes refresh the
+    // whole 3x3x3 neighborhood.
+    bool occlusion = vc__format_has_ao(ctx.format);
+    size_t lo = SIZE_MAX;
+    size_t hi = 0;
+    for (size_t i = 0; i < dirty->len; ++i) {
+        struct Size3D pos = Chunk_get_iaspos(chunk, dirty->data[i]);
+
+        for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx) {
+            int64_t nx = (int64_t)pos.x + dx;
+            int64_t ny = (int64_t)pos.y + dy;
+            int64_t nz = (int64_t)pos.z + dz;
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= chunk->size.x 
+                || ny >= chunk->size.y || nz >= chunk->size.z)
+                continue;
+
+            int manhattan = abs(dx) + abs(dy) + abs(dz);
+            if (!occlusion && manhattan > 1)
+                continue;
+
+            for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+                const int* dir = vc__face_dirs[face];
+                bool towards = dir[0] == -dx && dir[1] == -dy && dir[2] == -dz;
+                if (!occlusion && manhattan == 1 && !towards)
+                    continue;
+                vc__patch_face(mesh, &ctx, nx, ny, nz, face, occlusion, &lo, &hi);
+            }
+        }
+    }
+    dirty->len = 0;
+
+    // faces may be appended past the GPU buffer and then moved back below
+    // it within one batch, so the dirty range can outgrow the buffer even
+    // when the final vertex count fits
+    if (mesh->verts.len > mesh->gpu_cap 
+        || (lo < hi && hi * stride > mesh->gpu_cap)) {
+        vc__mesh_upload(mesh);
+    } else if (lo < hi) {
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 
+                        lo * stride * sizeof *mesh->verts.data,
+                        (hi - lo) * stride * sizeof *mesh->verts.data,
+                        mesh->verts.data + lo * stride);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void ChunkMesh_destroy(struct ChunkMesh* mesh) {
+    if (!mesh) {
+        FE_WARNING("Warning: NULL mesh passed to `ChunkMesh_destroy`");
+        return;
+    }
+
+    vc__float_verts_destroy(&mesh->verts);
+    vc__face_slots_destroy(&mesh->slots);
+    free(mesh->dirty.data);
+
+    glDeleteBuffers(1, &mesh->vbo);
+    glDeleteVertexArrays(1, &mesh->vao);
+    *mesh = (struct ChunkMesh){};
+}
+
+size_t ChunkMesh_vertex_count(struct ChunkMesh* mesh) {
+    switch (mesh->options.format) {
+        case CHUNK_VERTEX_PACKED:
+            return mesh->verts.len;
+        case CHUNK_VERTEX_INSTANCED:
+            return mesh->verts.len / CHUNK_FACE_RECORD_WORDS * VC__FACE_VERTS;
+        default:
+            return mesh->verts.len / SCALARS_PER_VERTEX;
+    }
+}
+
 size_t ChunkMesh_polygon_count(struct ChunkMesh* mesh) {
-    return mesh->verts.len;
+    if (mesh->options.indexed)
+        return ChunkMesh_vertex_count(mesh) / VC__QUAD_VERTS * POLYGONS_PER_FACE;
+    return ChunkMesh_vertex_count(mesh) / VERTICES_PER_POLYGON;
+}
+
+void ChunkMesh_draw(struct ChunkMesh* mesh) {
+    glBindVertexArray(mesh->vao);
+    if (mesh->options.format == CHUNK_VERTEX_INSTANCED) {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, VC__FACE_VERTS, 
+                              (GLsizei)(mesh->verts.len / CHUNK_FACE_RECORD_WORDS));
+    } else if (mesh->options.indexed) {
+        glDrawElements(GL_TRIANGLES, 
+                       (GLsizei)(ChunkMesh_polygon_count(mesh) * VERTICES_PER_POLYGON),
+                       GL_UNSIGNED_INT, (void*)0);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)ChunkMesh_vertex_count(mesh));
+    }
+}
+
+/**
+ * A chunk handed to a meshing worker. The chunk and its neighbors are 
+ * private copies, so the originals can keep being edited while the job
+ * runs. Finished jobs are chained in their queue's done list.
+ */
+struct vc__mesh_job_t {
+    struct ChunkMeshQueue* queue;
+    struct Chunk chunk;
+    struct Chunk neighbors[CHUNK_FACE_COUNT];
+    bool has_neighbor[CHUNK_FACE_COUNT];
+    struct ChunkMeshOptions options;
+    struct ChunkMesh mesh;
+    void* user;
+    struct vc__mesh_job_t* next;
+};
+
+static void vc__mesh_job_release(struct vc__mesh_job_t* job) {
+    Chunk_destroy(&job->chunk);
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        if (job->has_neighbor[face])
+            Chunk_destroy(&job->neighbors[face]);
+    }
+    free(job);
+}
+
+static void vc__mesh_job_run(void* arg) {
+    struct vc__mesh_job_t* job = arg;
+
+    struct Chunk* neighbors[CHUNK_FACE_COUNT];
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face)
+        neighbors[face] = job->has_neighbor[face] ? &job->neighbors[face] : NULL;
+
+    job->mesh = ChunkMesh__build(&job->chunk, neighbors, job->options);
+
+    struct ChunkMeshQueue* queue = job->queue;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->done_tail)
+        queue->done_tail->next = job;
+    else 
+        queue->done_head = job;
+    queue->done_tail = job;
+    --queue->running;
+    pthread_cond_broadcast(&queue->finished);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+struct ChunkMeshQueue* ChunkMeshQueue__create(struct JobPool* pool) {
+    struct ChunkMeshQueue* queue = calloc(1, sizeof *queue);
+    if (!queue) {
+        FE_FATAL("Could not allocate %lu bytes for chunk mesh queue.", 
+                 sizeof *queue);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    queue->pool = pool;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->finished, NULL);
+    return queue;
+}
+
+void ChunkMeshQueue_submit(struct ChunkMeshQueue* queue, 
+                           const struct Chunk* chunk, 
+                           struct Chunk* const neighbors[CHUNK_FACE_COUNT],
+                           struct ChunkMeshOptions options, void* user) {
+    struct vc__mesh_job_t* job = calloc(1, sizeof *job);
+    if (!job) {
+        FE_FATAL("Could not allocate %lu bytes for chunk mesh job.", 
+                 sizeof *job);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    job->queue = queue;
+    job->chunk = Chunk__copy(chunk);
+    for (int face = 0; neighbors && face < CHUNK_FACE_COUNT; ++face) {
+        if (neighbors[face]) {
+            job->neighbors[face] = Chunk__copy(neighbors[face]);
+            job->has_neighbor[face] = true;
+        }
+    }
+    job->options = options;
+    job->user = user;
+
+    pthread_mutex_lock(&queue->lock);
+    ++queue->running;
+    ++queue->pending;
+    pthread_mutex_unlock(&queue->lock);
+
+    JobPool_submit(queue->pool, vc__mesh_job_run, job);
+}
+
+size_t ChunkMeshQueue_poll(struct ChunkMeshQueue* queue, 
+                           struct ChunkMeshResult* results, size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        pthread_mutex_lock(&queue->lock);
+        struct vc__mesh_job_t* job = queue->done_head;
+        if (job) {
+            queue->done_head = job->next;
+            if (!queue->done_head)
+                queue->done_tail = NULL;
+            --queue->pending;
+        }
+        pthread_mutex_unlock(&queue->lock);
+
+        if (!job)
+            break;
+
+        ChunkMesh_upload(&job->mesh);
+        results[count++] = (struct ChunkMeshResult){ 
+            .mesh = job->mesh, .user = job->user };
+        vc__mesh_job_release(job);
+    }
+
+    return count;
+}
+
+size_t ChunkMeshQueue_pending(struct ChunkMeshQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    size_t pending = queue->pending;
+    pthread_mutex_unlock(&queue->lock);
+    return pending;
+}
+
+void ChunkMeshQueue_destroy(struct ChunkMeshQueue* queue) {
+    if (!queue) {
+        FE_WARNING("Warning: NULL queue passed to `ChunkMeshQueue_destroy`");
+        return;
+    }
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->running > 0)
+        pthread_cond_wait(&queue->finished, &queue->lock);
+    pthread_mutex_unlock(&queue->lock);
+
+    // meshes that were never polled were never uploaded either
+    while (queue->done_head) {
+        struct vc__mesh_job_t* job = queue->done_head;
+        queue->done_head = job->next;
+        vc__float_verts_destroy(&job->mesh.verts);
+        vc__mesh_job_release(job);
+    }
+
+    pthread_cond_destroy(&queue->finished);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue);
 }
@@ -0,0 +1,208 @@
+#include <fe/world.h>
+#include <fe/logger.h>
+#include <fe/err.h>
+
+#define FE_WORLD_COORD_BIAS (1 << 20)
+#define FE_WORLD_COORD_MASK 0x1FFFFFULL
+
+// grow once the table is 3/4 full, linear probing degrades quickly past that
+#define FE_WORLD_MAX_LOAD(cap) ((cap) - (cap) / 4)
+
+// indexed by `enum ChunkFace`, as in vchunk.c
+static const int32_t fe__world_face_dirs[CHUNK_FACE_COUNT][3] = {
+    [CHUNK_FACE_NEG_Z] = {  0,  0, -1 },
+    [CHUNK_FACE_POS_X] = {  1,  0,  0 },
+    [CHUNK_FACE_POS_Z] = {  0,  0,  1 },
+    [CHUNK_FACE_NEG_X] = { -1,  0,  0 },
+    [CHUNK_FACE_POS_Y] = {  0,  1,  0 },
+    [CHUNK_FACE_NEG_Y] = {  0, -1,  0 },
+};
+
+static inline uint64_t fe__world_key(struct ChunkCoord coord) {
+    return ((uint64_t)(coord.x + FE_WORLD_COORD_BIAS) & FE_WORLD_COORD_MASK)
+        | ((uint64_t)(coord.y + FE_WORLD_COORD_BIAS) & FE_WORLD_COORD_MASK) << 21
+        | ((uint64_t)(coord.z + FE_WORLD_COORD_BIAS) & FE_WORLD_COORD_MASK) << 42;
+}
+
+/**
+ * @brief Home slot of `key`. Neighboring coordinates differ in a few low
+ * bits of each component, so the key is mixed (splitmix64 finalizer)
+ * before being masked down to the table.
+ */
+static inline size_t fe__world_home(const struct World* world, uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ULL;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return (size_t)key & (world->cap - 1);
+}
+
+/**
+ * @brief Returns the slot holding `key`, or the empty slot ending its
+ * probe sequence. The table must not be full.
+ */
+static size_t fe__world_find(const struct World* world, uint64_t key) {
+    size_t mask = world->cap - 1;
+    size_t slot = fe__world_home(world, key);
+    while (world->slots[slot].entry && world->slots[slot].key != key)
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+static void fe__world_grow(struct World* world) {
+    size_t cap = world->cap ? world->cap * 2 : 64;
+    struct fe__world_slot_t* slots = calloc(cap, sizeof *slots);
+    if (!slots) {
+        FE_FATAL("Could not allocate %lu bytes for world table.",
+                 cap * sizeof *slots);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+
+    struct fe__world_slot_t* old = world->slots;
+    size_t old_cap = world->cap;
+    world->slots = slots;
+    world->cap = cap;
+
+    for (size_t i = 0; i < old_cap; ++i) {
+        if (old[i].entry)
+            world->slots[fe__world_find(world, old[i].key)] = old[i];
+    }
+    free(old);
+}
+
+static void fe__world_chunk_destroy(struct WorldChunk* entry) {
+    if (entry->meshed)
+        ChunkMesh_destroy(&entry->mesh);
+    Chunk_destroy(&entry->chunk);
+    free(entry);
+}
+
+struct World World__create(struct Size3D chunk_size) {
+    return (struct World){ .chunk_size = chunk_size };
+}
+
+void World_destroy(struct World* world) {
+    if (!world) {
+        FE_WARNING("Warning: NULL world passed to `World_destroy`");
+        return;
+    }
+
+    for (size_t i = 0; i < world->cap; ++i) {
+        if (world->slots[i].entry)
+            fe__world_chunk_destroy(world->slots[i].entry);
+    }
+    free(world->slots);
+    *world = (struct World){ .chunk_size = world->chunk_size };
+}
+
+struct WorldChunk* World_insert(struct World* world, struct ChunkCoord coord,
+                                struct Chunk chunk) {
+    if (chunk.size.x != world->chunk_size.x
+        || chunk.size.y != world->chunk_size.y
+        || chunk.size.z != world->chunk_size.z) {
+        FE_WARNING("Chunk size does not match world chunk size, neighbors "
+                   "will not cull across it.");
+    }
+
+    if (world->len + 1 > FE_WORLD_MAX_LOAD(world->cap))
+        fe__world_grow(world);
+
+    uint64_t key = fe__world_key(coord);
+    struct fe__world_slot_t* slot = world->slots + fe__world_find(world, key);
+    if (slot->entry) {
+        struct WorldChunk* entry = slot->entry;
+        if (entry->meshed)
+            ChunkMesh_destroy(&entry->mesh);
+        Chunk_destroy(&entry->chunk);
+
+        // a mesh of the old chunk may still come back for this entry 
+        bool meshing = entry->meshing;
+        *entry = (struct WorldChunk){ 
+            .coord = coord, .chunk = chunk, 
+            .meshing = meshing, .stale = meshing };
+        return entry;
+    }
+
+    struct WorldChunk* entry = malloc(sizeof *entry);
+    if (!entry) {
+        FE_FATAL("Could not allocate %lu bytes for world chunk.",
+                 sizeof *entry);
+        exit(FE_ERR_BAD_ALLOC);
+    }
+    *entry = (struct WorldChunk){ .coord = coord, .chunk = chunk };
+
+    slot->key = key;
+    slot->entry = entry;
+    ++world->len;
+    return entry;
+}
+
+struct WorldChunk* World_get(const struct World* world, struct ChunkCoord coord) {
+    if (world->len == 0)
+        return NULL;
+    return world->slots[fe__world_find(world, fe__world_key(coord))].entry;
+}
+
+bool World_remove(struct World* world, struct ChunkCoord coord) {
+    if (world->len == 0)
+        return false;
+
+    size_t mask = world->cap - 1;
+    size_t hole = fe__world_find(world, fe__world_key(coord));
+    if (!world->slots[hole].entry)
+        return false;
+    if (world->slots[hole].entry->meshing) {
+        FE_WARNING("Not removing chunk (%d, %d, %d) while it is being meshed.",
+                   coord.x, coord.y, coord.z);
+        return false;
+    }
+
+    fe__world_chunk_destroy(world->slots[hole].entry);
+    --world->len;
+
+    // Backward shift deletion: move every later entry of the cluster whose
+    // home slot is not between the hole and itself into the hole.
+    for (size_t slot = (hole + 1) & mask; world->slots[slot].entry;
+         slot = (slot + 1) & mask) {
+        size_t home = fe__world_home(world, world->slots[slot].key);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            world->slots[hole] = world->slots[slot];
+            hole = slot;
+        }
+    }
+    world->slots[hole] = (struct fe__world_slot_t){ 0 };
+
+    return true;
+}
+
+void World_neighbors(const struct World* world, struct ChunkCoord coord,
+                     struct Chunk* neighbors[CHUNK_FACE_COUNT]) {
+    for (int face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const int32_t* dir = fe__world_face_dirs[face];
+        struct WorldChunk* entry = World_get(world, (struct ChunkCoord){
+            coord.x + dir[0], coord.y + dir[1], coord.z + dir[2] });
+        neighbors[face] = entry ? &entry->chunk : NULL;
+    }
+}
+
+struct WorldChunk* World_next(const struct World* world, size_t* cursor) {
+    while (*cursor < world->cap) {
+        struct WorldChunk* entry = world->slots[(*cursor)++].entry;
+        if (entry)
+            return entry;
+    }
+    return NULL;
+}
+
+size_t World_count(const struct World* world) {
+    return world->len;
+}
+
+struct ChunkCoord World_chunk_origin(const struct World* world,
+                                     struct ChunkCoord coord) {
+    return (struct ChunkCoord){
+        coord.x * (int32_t)world->chunk_size.x,
+        coord.y * (int32_t)world->chunk_size.y,
+        coord.z * (int32_t)world->chunk_size.z };
+}